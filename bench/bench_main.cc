@@ -0,0 +1,447 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host benchmark for lvgl-msg-bus.
+ *
+ * Builds the component against the shims in host/include and measures
+ * Publish() throughput across delivery modes, subscriber counts, payload
+ * sizes and producer thread counts, plus DataStore::SetRaw() / GetRaw() /
+ * GetRawIfNewer() latency.  A dedicated "LVGL thread" pumps lv_timer_handler() so async
+ * deliveries are timed end to end.
+ *
+ *   msgbus_bench [--dispatch batched|per-message] [--messages N] [--quick]
+ *                [--markdown]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lvgl.h>
+
+#include "lvgl_msg_bus/data_store.h"
+#include "lvgl_msg_bus/message_bus.h"
+
+using namespace msgbus;
+
+// ---------------------------------------------------------------------------
+// Allocation counter
+// ---------------------------------------------------------------------------
+
+// Interpose malloc so every allocation in the process is counted (operator
+// new goes through malloc in libstdc++).  glibc only.
+static std::atomic<uint64_t> g_allocs{0};
+
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCS 1
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+} // extern "C"
+#else
+#define BENCH_COUNT_ALLOCS 0
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Parameters
+// ---------------------------------------------------------------------------
+
+constexpr uint32_t kHotTopic      = 0x100;
+constexpr size_t   kFillerTopics  = 128;      // Idle subscriptions around the hot topic.
+constexpr uint32_t kSentinel      = 0xffffffffu;
+constexpr size_t   kQueueDepth    = 1024;
+constexpr uint32_t kDataStoreKey  = 7;
+
+const DeliveryMode kModes[]       = {DeliveryMode::Immediate, DeliveryMode::LvglAsync,
+                                     DeliveryMode::LvglLatest, DeliveryMode::Worker};
+const size_t       kSubscribers[] = {1, 8, 64};
+const size_t       kPayloads[]    = {4, 64, 512};
+const size_t       kProducers[]   = {1, 2, 4};
+
+struct Options {
+    LvglDispatch dispatch = LvglDispatch::Batched;
+    size_t       messages = 0;   // 0 = per-mode default.
+    bool         quick    = false;
+    bool         markdown = false;
+    size_t       wildcards = 0;  // Idle range + mask subscriptions to add.
+    bool         flat_store = false;
+};
+
+struct Result {
+    std::string name;
+    size_t      messages;
+    uint64_t    delivered;
+    double      seconds;
+    uint64_t    allocs;
+    bool        complete;
+};
+
+const char* ModeName(DeliveryMode mode) {
+    switch (mode) {
+    case DeliveryMode::Immediate:  return "Immediate";
+    case DeliveryMode::LvglAsync:  return "LvglAsync";
+    case DeliveryMode::LvglLatest: return "LvglLatest";
+    case DeliveryMode::Worker:     return "Worker";
+    }
+    return "?";
+}
+
+double Now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// LVGL thread
+// ---------------------------------------------------------------------------
+
+std::atomic<bool> g_lvgl_run{true};
+
+void LvglThread() {
+    while (g_lvgl_run.load(std::memory_order_relaxed)) {
+        lv_timer_handler();
+        if (lv_host_pending_timers() == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Publish cases
+// ---------------------------------------------------------------------------
+
+std::atomic<uint64_t> g_issued{0};      // Messages published so far.
+std::atomic<uint64_t> g_delivered{0};   // Callbacks executed.
+std::atomic<uint64_t> g_sentinels{0};   // Subscribers that saw the final message.
+
+void OnMessage(const Message& msg) {
+    g_delivered.fetch_add(1, std::memory_order_relaxed);
+    uint32_t seq = 0;
+    std::memcpy(&seq, msg.data, sizeof(seq));
+    if (seq == kSentinel) {
+        g_sentinels.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool WaitFor(const std::atomic<uint64_t>& counter, uint64_t target) {
+    const double deadline = Now() + 30.0;
+    while (counter.load(std::memory_order_acquire) < target) {
+        if (Now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+Result RunPublish(DeliveryMode mode, size_t subs, size_t payload,
+                  size_t producers, size_t messages) {
+    MessageBus& bus = MessageBus::GetInstance();
+
+    std::vector<SubscriptionId> ids;
+    for (size_t i = 0; i < subs; ++i) {
+        ids.push_back(bus.Subscribe(kHotTopic, OnMessage, mode));
+    }
+
+    g_issued.store(0);
+    g_delivered.store(0);
+    g_sentinels.store(0);
+
+    // Async producers are throttled to what the LVGL thread (or the workers)
+    // drain, so the result is sustained throughput rather than queue growth.
+    // LvglLatest is self-limiting.
+    const uint64_t window = std::max<uint64_t>(1, kQueueDepth / 2 / subs) * subs;
+    const bool     paced  = mode == DeliveryMode::LvglAsync || mode == DeliveryMode::Worker;
+    const size_t   per_producer = messages / producers;
+
+    std::vector<uint8_t> last(payload, 0);
+    std::memcpy(last.data(), &kSentinel, sizeof(kSentinel));
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<uint8_t> buf(payload, static_cast<uint8_t>(p));
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < per_producer; ++i) {
+                if (paced) {
+                    while (g_issued.load(std::memory_order_relaxed) * subs -
+                               g_delivered.load(std::memory_order_relaxed) > window) {
+                        std::this_thread::yield();
+                    }
+                }
+                const uint32_t seq = static_cast<uint32_t>(i);
+                std::memcpy(buf.data(), &seq, sizeof(seq));
+                bus.Publish(kHotTopic, buf.data(), payload);
+                g_issued.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    const uint64_t allocs_before = g_allocs.load();
+    const double   start         = Now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // One final message marks the end; conflation never drops the newest.
+    bus.Publish(kHotTopic, last.data(), payload);
+
+    const size_t total    = per_producer * producers + 1;
+    const bool   complete = mode == DeliveryMode::LvglLatest
+                                ? WaitFor(g_sentinels, subs)
+                                : WaitFor(g_delivered, total * subs);
+    const double   seconds = Now() - start;
+    const uint64_t allocs  = g_allocs.load() - allocs_before;
+
+    for (SubscriptionId id : ids) {
+        bus.Unsubscribe(id);
+    }
+
+    char name[96];
+    snprintf(name, sizeof(name), "%-10s subs=%-3u payload=%-4u producers=%u",
+             ModeName(mode), (unsigned)subs, (unsigned)payload, (unsigned)producers);
+    return Result{name, total, g_delivered.load(), seconds, allocs, complete};
+}
+
+// ---------------------------------------------------------------------------
+// DataStore cases
+// ---------------------------------------------------------------------------
+
+Result RunDataStore(const char* op, size_t payload, size_t iterations) {
+    DataStore& store = DataStore::GetInstance();
+    const bool changing = std::strcmp(op, "SetRaw changed") == 0;
+    const bool reading  = std::strcmp(op, "GetRaw") == 0;
+    const bool polling  = std::strcmp(op, "GetIfNewer") == 0;   // Unchanged key.
+
+    std::vector<uint8_t> buf(payload, 0);
+    store.SetRaw(kDataStoreKey, buf.data(), payload);
+
+    // One LVGL-thread watcher, like a UI page bound to the key.
+    g_delivered.store(0);
+    Subscription watch = store.Watch(kDataStoreKey, [](uint32_t) {
+        g_delivered.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    const uint64_t allocs_before = g_allocs.load();
+    const double   start         = Now();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (reading) {
+            store.GetRaw(kDataStoreKey, buf.data(), payload);
+            continue;
+        }
+        if (polling) {
+            uint32_t seen = store.Version();
+            store.GetRawIfNewer(kDataStoreKey, seen, buf.data(), payload);
+            continue;
+        }
+        if (changing) {
+            while ((i - g_delivered.load(std::memory_order_relaxed)) > kQueueDepth / 2) {
+                std::this_thread::yield();
+            }
+            const uint32_t seq = static_cast<uint32_t>(i + 1);
+            std::memcpy(buf.data(), &seq, sizeof(seq));
+        }
+        store.SetRaw(kDataStoreKey, buf.data(), payload);
+    }
+    const bool     complete = !changing || WaitFor(g_delivered, iterations);
+    const double   seconds  = Now() - start;
+    const uint64_t allocs   = g_allocs.load() - allocs_before;
+
+    watch.Reset();
+
+    char name[96];
+    snprintf(name, sizeof(name), "DataStore  %-14s payload=%u", op, (unsigned)payload);
+    return Result{name, iterations, g_delivered.load(), seconds, allocs, complete};
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+void PrintHeader(const Options& opt) {
+    const char* dispatch = opt.dispatch == LvglDispatch::Batched ? "batched" : "per-message";
+    if (opt.markdown) {
+        printf("### lvgl-msg-bus host benchmark (dispatch: %s)\n\n", dispatch);
+        printf("| case | msgs | msgs/s | ns/op | deliveries/s | allocs/msg |\n");
+        printf("|---|---:|---:|---:|---:|---:|\n");
+    } else {
+        printf("lvgl-msg-bus host benchmark (dispatch: %s, %u filler subscriptions)\n",
+               dispatch, (unsigned)kFillerTopics);
+        printf("%-52s %9s %12s %9s %13s %10s\n", "case", "msgs", "msgs/s",
+               "ns/op", "deliveries/s", "allocs/msg");
+    }
+}
+
+void PrintResult(const Options& opt, const Result& r) {
+    const double rate   = r.messages / r.seconds;
+    const double ns     = r.seconds * 1e9 / r.messages;
+    const double drate  = r.delivered / r.seconds;
+    char allocs[32];
+    if (BENCH_COUNT_ALLOCS) {
+        snprintf(allocs, sizeof(allocs), "%.2f", double(r.allocs) / r.messages);
+    } else {
+        snprintf(allocs, sizeof(allocs), "n/a");
+    }
+    const char* flag = r.complete ? "" : " (TIMEOUT)";
+
+    if (opt.markdown) {
+        printf("| `%s`%s | %zu | %.0f | %.1f | %.0f | %s |\n", r.name.c_str(), flag,
+               r.messages, rate, ns, drate, allocs);
+    } else {
+        printf("%-52s %9zu %12.0f %9.1f %13.0f %10s%s\n", r.name.c_str(), r.messages,
+               rate, ns, drate, allocs, flag);
+    }
+    fflush(stdout);
+}
+
+bool ParseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dispatch" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (value == "batched") {
+                opt.dispatch = LvglDispatch::Batched;
+            } else if (value == "per-message") {
+                opt.dispatch = LvglDispatch::PerMessage;
+            } else {
+                return false;
+            }
+        } else if (arg == "--messages" && i + 1 < argc) {
+            opt.messages = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--wildcards" && i + 1 < argc) {
+            opt.wildcards = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--flat-store") {
+            opt.flat_store = true;
+        } else if (arg == "--quick") {
+            opt.quick = true;
+        } else if (arg == "--markdown") {
+            opt.markdown = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!ParseArgs(argc, argv, opt)) {
+        fprintf(stderr, "usage: %s [--dispatch batched|per-message] [--messages N] "
+                        "[--wildcards N] [--flat-store] [--quick] [--markdown]\n", argv[0]);
+        return 2;
+    }
+
+    // Pool and ring sized for the pacing window so the steady state runs
+    // without heap fallback; the default LVGL batch limit would pace async
+    // throughput by the 1 ms continuation timer instead of the bus.
+    BusConfig config;
+    config.lvgl_dispatch            = opt.dispatch;
+    config.lvgl_queue_depth         = kQueueDepth;
+    config.lvgl_batch_size          = 0;
+    config.worker_count             = 2;
+    config.worker_queue_depth       = kQueueDepth;
+    config.payload_pool.block_counts[0] = 1024;
+    config.payload_pool.block_counts[1] = 512;
+    config.payload_pool.block_counts[2] = 512;
+    if (MessageBus::GetInstance().Initialize(config) != ESP_OK) {
+        return 1;
+    }
+    DataStoreConfig store_config;
+    store_config.max_entry_size = 512;
+    store_config.capacity       = opt.flat_store ? 64 : 0;
+    if (DataStore::GetInstance().Initialize(store_config) != ESP_OK) {
+        return 1;
+    }
+
+    std::thread lvgl(LvglThread);
+
+    MessageBus& bus = MessageBus::GetInstance();
+    std::vector<SubscriptionId> filler;
+    for (size_t i = 0; i < kFillerTopics; ++i) {
+        const uint32_t topic = kHotTopic - kFillerTopics / 2 + i;
+        if (topic != kHotTopic) {
+            filler.push_back(bus.Subscribe(topic, OnMessage, DeliveryMode::Immediate));
+        }
+    }
+    // Wildcards that never match the hot topic: overlapping ranges above it
+    // and masks spread over four distinct mask groups.
+    SubscribeOptions idle;
+    idle.mode = DeliveryMode::Immediate;
+    for (size_t i = 0; i < opt.wildcards; ++i) {
+        const uint32_t first = 0x10000 + static_cast<uint32_t>(i) * 16;
+        filler.push_back(bus.SubscribeRange(first, first + 64, OnMessage, idle));
+        filler.push_back(bus.SubscribeMask(0x00F00000 | static_cast<uint32_t>(i),
+                                           0x00F000FF | (0x100u << (i % 4)),
+                                           OnMessage, idle));
+    }
+
+    PrintHeader(opt);
+
+    const size_t scale = opt.quick ? 10 : 1;
+    bool ok = true;
+    for (DeliveryMode mode : kModes) {
+        const size_t messages = opt.messages
+            ? opt.messages
+            : (mode == DeliveryMode::Immediate ? 400000 : 100000) / scale;
+        for (size_t subs : kSubscribers) {
+            for (size_t payload : kPayloads) {
+                for (size_t producers : kProducers) {
+                    const Result r = RunPublish(mode, subs, payload, producers, messages);
+                    PrintResult(opt, r);
+                    ok = ok && r.complete;
+                }
+            }
+        }
+    }
+
+    const size_t iterations = opt.messages ? opt.messages : 200000 / scale;
+    for (const char* op : {"SetRaw changed", "SetRaw same", "GetRaw", "GetIfNewer"}) {
+        for (size_t payload : kPayloads) {
+            const Result r = RunDataStore(op, payload, iterations);
+            PrintResult(opt, r);
+            ok = ok && r.complete;
+        }
+    }
+
+    const BusStats stats = bus.GetBusStats();
+    printf("%spool heap fallbacks: %lu, alloc failures: %lu\n", opt.markdown ? "\n" : "",
+           (unsigned long)stats.pool_heap_fallbacks, (unsigned long)stats.alloc_failures);
+
+    for (SubscriptionId id : filler) {
+        bus.Unsubscribe(id);
+    }
+    g_lvgl_run.store(false);
+    lvgl.join();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host implementation of the FreeRTOS / esp_timer / heap_caps shims.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+namespace {
+
+std::chrono::milliseconds ToDuration(TickType_t ticks) {
+    // portMAX_DELAY: wait "forever" (a day is plenty for a benchmark).
+    return std::chrono::milliseconds(ticks == portMAX_DELAY ? 86400000u : ticks);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Time
+// ---------------------------------------------------------------------------
+
+int64_t esp_timer_get_time() {
+    using namespace std::chrono;
+    static const steady_clock::time_point boot = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - boot).count();
+}
+
+// One-shot timers: each start spawns a sleeper thread; a generation bump
+// cancels the sleepers of earlier starts.
+struct esp_timer {
+    esp_timer_cb_t        callback;
+    void*                 arg;
+    std::mutex            lock;
+    uint64_t              generation = 0;
+};
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    auto* timer     = new esp_timer();
+    timer->callback = args->callback;
+    timer->arg      = args->arg;
+    *out = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> guard(timer->lock);
+        generation = ++timer->generation;
+    }
+    std::thread([timer, generation, timeout_us] {
+        std::this_thread::sleep_for(std::chrono::microseconds(timeout_us));
+        {
+            std::lock_guard<std::mutex> guard(timer->lock);
+            if (timer->generation != generation) {
+                return;
+            }
+        }
+        timer->callback(timer->arg);
+    }).detach();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> guard(timer->lock);
+    ++timer->generation;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    // Leaked on purpose: a sleeper thread may still hold it.
+    esp_timer_stop(timer);
+    return ESP_OK;
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(esp_timer_get_time() / 1000);
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+// ---------------------------------------------------------------------------
+// Heap
+// ---------------------------------------------------------------------------
+
+void* heap_caps_malloc(size_t size, uint32_t /*caps*/) {
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t /*caps*/) {
+    return calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+// ---------------------------------------------------------------------------
+// Semaphores
+// ---------------------------------------------------------------------------
+
+struct HostSemaphore {
+    bool                    is_mutex = false;
+    std::timed_mutex        mutex;
+    std::mutex              lock;
+    std::condition_variable cv;
+    UBaseType_t             count = 0;
+    UBaseType_t             max_count = 1;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    auto* sem = new HostSemaphore();
+    sem->is_mutex = true;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial) {
+    auto* sem = new HostSemaphore();
+    sem->max_count = max_count;
+    sem->count     = initial;
+    return sem;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    delete sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (sem->is_mutex) {
+        return sem->mutex.try_lock_for(ToDuration(ticks)) ? pdTRUE : pdFALSE;
+    }
+    std::unique_lock<std::mutex> guard(sem->lock);
+    if (!sem->cv.wait_for(guard, ToDuration(ticks), [sem] { return sem->count > 0; })) {
+        return pdFALSE;
+    }
+    --sem->count;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (sem->is_mutex) {
+        sem->mutex.unlock();
+        return pdTRUE;
+    }
+    std::lock_guard<std::mutex> guard(sem->lock);
+    if (sem->count >= sem->max_count) {
+        return pdFALSE;
+    }
+    ++sem->count;
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+// ---------------------------------------------------------------------------
+// Tasks
+// ---------------------------------------------------------------------------
+
+struct HostTask {
+    std::mutex              lock;
+    std::condition_variable cv;
+    uint32_t                notify = 0;
+};
+
+namespace {
+thread_local HostTask* t_current_task = nullptr;
+std::atomic<UBaseType_t> g_task_count{0};   // Created and not yet deleted.
+std::atomic<uint32_t>    g_task_failures{0};
+} // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* /*name*/,
+                                   uint32_t /*stack*/, void* arg,
+                                   UBaseType_t /*prio*/, TaskHandle_t* handle,
+                                   BaseType_t /*core*/) {
+    uint32_t failures = g_task_failures.load(std::memory_order_relaxed);
+    while (failures > 0 &&
+           !g_task_failures.compare_exchange_weak(failures, failures - 1,
+                                                  std::memory_order_relaxed)) {
+    }
+    if (failures > 0) {
+        return pdFAIL;
+    }
+    auto* task = new HostTask();
+    if (handle) {
+        *handle = task;
+    }
+    g_task_count.fetch_add(1, std::memory_order_relaxed);
+    std::thread([task, fn, arg] {
+        t_current_task = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* arg, UBaseType_t prio, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Host threads are detached and end with the process; only the count of
+    // live tasks changes.
+    if (task) {
+        g_task_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    return g_task_count.load(std::memory_order_relaxed);
+}
+
+void host_fail_task_creates(uint32_t count) {
+    g_task_failures.store(count, std::memory_order_relaxed);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(ToDuration(ticks));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!t_current_task) {
+        t_current_task = new HostTask();  // Threads not created via xTaskCreate.
+    }
+    return t_current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(task->lock);
+    ++task->notify;
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) {
+        *woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    HostTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> guard(task->lock);
+    task->cv.wait_for(guard, ToDuration(ticks), [task] { return task->notify > 0; });
+    const uint32_t value = task->notify;
+    if (clear_on_exit) {
+        task->notify = 0;
+    } else if (value > 0) {
+        --task->notify;
+    }
+    return value;
+}
+
+BaseType_t xPortGetCoreID() {
+    return 0;
+}
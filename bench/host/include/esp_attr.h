@@ -0,0 +1,11 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef MSGBUS_HOST_ESP_ATTR_H
+#define MSGBUS_HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+
+#endif // MSGBUS_HOST_ESP_ATTR_H
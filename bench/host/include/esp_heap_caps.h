@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: heap_caps_* forward to malloc / free; caps are ignored.
+ */
+
+#ifndef MSGBUS_HOST_ESP_HEAP_CAPS_H
+#define MSGBUS_HOST_ESP_HEAP_CAPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void  heap_caps_free(void* ptr);
+
+#endif // MSGBUS_HOST_ESP_HEAP_CAPS_H
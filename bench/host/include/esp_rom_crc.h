@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: esp_rom_crc32_le() (reflected CRC-32, polynomial 0xEDB88320).
+ */
+
+#ifndef MSGBUS_HOST_ESP_ROM_CRC_H
+#define MSGBUS_HOST_ESP_ROM_CRC_H
+
+#include <cstdint>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+#endif // MSGBUS_HOST_ESP_ROM_CRC_H
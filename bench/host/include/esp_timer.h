@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: esp_timer_get_time() backed by steady_clock, and one-shot
+ * esp_timer callbacks run on a helper thread.
+ */
+
+#ifndef MSGBUS_HOST_ESP_TIMER_H
+#define MSGBUS_HOST_ESP_TIMER_H
+
+#include <cstdint>
+
+#include <esp_err.h>
+
+int64_t esp_timer_get_time();
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t       callback;
+    void*                arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char*          name;
+    bool                 skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+#endif // MSGBUS_HOST_ESP_TIMER_H
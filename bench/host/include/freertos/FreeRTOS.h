@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: FreeRTOS types, a 1 kHz tick and portMUX spinlocks on std::mutex.
+ */
+
+#ifndef MSGBUS_HOST_FREERTOS_FREERTOS_H
+#define MSGBUS_HOST_FREERTOS_FREERTOS_H
+
+#include <cstdint>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE             1
+#define pdFALSE            0
+#define pdPASS             1
+#define pdFAIL             0
+#define portMAX_DELAY      0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define tskNO_AFFINITY     0x7fffffff
+#define configMAX_PRIORITIES 25
+
+struct portMUX_TYPE {
+    std::recursive_mutex m;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux)      (mux)->m.lock()
+#define portEXIT_CRITICAL(mux)       (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux)  (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux)   (mux)->m.unlock()
+#define portENTER_CRITICAL_SAFE(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL_SAFE(mux)  (mux)->m.unlock()
+#define portYIELD_FROM_ISR(woken)    (void)(woken)
+#define xPortInIsrContext()          0
+
+TickType_t xTaskGetTickCount();
+TickType_t xTaskGetTickCountFromISR();
+
+#endif // MSGBUS_HOST_FREERTOS_FREERTOS_H
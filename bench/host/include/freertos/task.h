@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: tasks are detached std::threads with a notification counter.
+ */
+
+#ifndef MSGBUS_HOST_FREERTOS_TASK_H
+#define MSGBUS_HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name,
+                                   uint32_t stack, void* arg, UBaseType_t prio,
+                                   TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* arg, UBaseType_t prio, TaskHandle_t* handle);
+void         vTaskDelete(TaskHandle_t task);
+UBaseType_t  uxTaskGetNumberOfTasks();
+void         vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+void         vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+uint32_t     ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t   xPortGetCoreID();
+
+/// Host only: make the next @p count task creations fail (out of memory).
+void         host_fail_task_creates(uint32_t count);
+
+#endif // MSGBUS_HOST_FREERTOS_TASK_H
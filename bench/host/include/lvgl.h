@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: the LVGL timer / async API used by lvgl-msg-bus.  Thread-safe,
+ * so producer threads may call lv_async_call() while a "LVGL thread" runs
+ * lv_timer_handler().
+ */
+
+#ifndef MSGBUS_HOST_LVGL_H
+#define MSGBUS_HOST_LVGL_H
+
+#include <cstdint>
+
+typedef enum {
+    LV_RESULT_INVALID = 0,
+    LV_RESULT_OK,
+} lv_result_t;
+
+typedef struct _lv_timer_t lv_timer_t;
+typedef void (*lv_async_cb_t)(void* user_data);
+typedef void (*lv_timer_cb_t)(lv_timer_t* timer);
+
+lv_result_t lv_async_call(lv_async_cb_t cb, void* user_data);
+lv_timer_t* lv_timer_create(lv_timer_cb_t cb, uint32_t period, void* user_data);
+void        lv_timer_set_repeat_count(lv_timer_t* timer, int32_t repeat_count);
+void*       lv_timer_get_user_data(lv_timer_t* timer);
+void        lv_timer_delete(lv_timer_t* timer);
+uint32_t    lv_timer_handler();
+uint32_t    lv_tick_get();
+
+/// Host only: number of timers currently pending.
+uint32_t    lv_host_pending_timers();
+
+/// Host only: make the next @p count lv_async_call()s fail, as they do when
+/// the LVGL heap is exhausted.
+void        lv_host_fail_async_calls(uint32_t count);
+
+#endif // MSGBUS_HOST_LVGL_H
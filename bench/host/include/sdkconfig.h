@@ -0,0 +1,11 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: Kconfig options are passed as compile definitions instead.
+ */
+
+#ifndef MSGBUS_HOST_SDKCONFIG_H
+#define MSGBUS_HOST_SDKCONFIG_H
+
+#endif // MSGBUS_HOST_SDKCONFIG_H
@@ -0,0 +1,131 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host implementation of the LVGL timer shim.  Mirrors what matters for the
+ * bus: lv_async_call() creates a one-shot timer, and lv_timer_handler() runs
+ * every timer whose period has elapsed.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <lvgl.h>
+#include <freertos/FreeRTOS.h>
+
+struct _lv_timer_t {
+    lv_timer_cb_t cb         = nullptr;
+    lv_async_cb_t async_cb   = nullptr;
+    void*         user_data  = nullptr;
+    uint32_t      period     = 0;
+    uint32_t      last_run   = 0;
+    int32_t       repeat     = -1;
+};
+
+namespace {
+
+// One heap allocation per timer, like LVGL: the vectors only grow.
+std::mutex               g_timer_lock;
+std::vector<lv_timer_t*> g_timers;
+std::vector<lv_timer_t*> g_due;     // Only touched by lv_timer_handler().
+std::atomic<uint32_t>    g_async_failures{0};
+
+lv_timer_t* AddTimer(lv_timer_t* timer) {
+    timer->last_run = lv_tick_get();
+    std::lock_guard<std::mutex> guard(g_timer_lock);
+    g_timers.push_back(timer);
+    return timer;
+}
+
+} // namespace
+
+uint32_t lv_tick_get() {
+    return xTaskGetTickCount();
+}
+
+lv_timer_t* lv_timer_create(lv_timer_cb_t cb, uint32_t period, void* user_data) {
+    auto* timer      = new lv_timer_t();
+    timer->cb        = cb;
+    timer->user_data = user_data;
+    timer->period    = period;
+    return AddTimer(timer);
+}
+
+lv_result_t lv_async_call(lv_async_cb_t cb, void* user_data) {
+    uint32_t failures = g_async_failures.load(std::memory_order_relaxed);
+    while (failures > 0 &&
+           !g_async_failures.compare_exchange_weak(failures, failures - 1,
+                                                   std::memory_order_relaxed)) {
+    }
+    if (failures > 0) {
+        return LV_RESULT_INVALID;
+    }
+    // Fill the timer in before publishing it: lv_timer_handler() may run it
+    // on another thread right away.
+    auto* timer      = new lv_timer_t();
+    timer->async_cb  = cb;
+    timer->user_data = user_data;
+    timer->repeat    = 1;
+    AddTimer(timer);
+    return LV_RESULT_OK;
+}
+
+void lv_timer_set_repeat_count(lv_timer_t* timer, int32_t repeat_count) {
+    timer->repeat = repeat_count;
+}
+
+void* lv_timer_get_user_data(lv_timer_t* timer) {
+    return timer->user_data;
+}
+
+void lv_timer_delete(lv_timer_t* timer) {
+    std::lock_guard<std::mutex> guard(g_timer_lock);
+    g_timers.erase(std::remove(g_timers.begin(), g_timers.end(), timer), g_timers.end());
+    delete timer;
+}
+
+uint32_t lv_timer_handler() {
+    // Take the due timers out of the list; timers created while they run
+    // wait for the next call, like a real lv_timer_handler() pass.
+    const uint32_t now = lv_tick_get();
+    g_due.clear();
+    {
+        std::lock_guard<std::mutex> guard(g_timer_lock);
+        size_t kept = 0;
+        for (lv_timer_t* timer : g_timers) {
+            if (now - timer->last_run >= timer->period) {
+                g_due.push_back(timer);
+            } else {
+                g_timers[kept++] = timer;
+            }
+        }
+        g_timers.resize(kept);
+    }
+
+    for (lv_timer_t* timer : g_due) {
+        timer->last_run = now;
+        if (timer->async_cb) {
+            timer->async_cb(timer->user_data);
+        } else {
+            timer->cb(timer);
+        }
+        if (timer->repeat > 0 && --timer->repeat == 0) {
+            delete timer;
+            continue;
+        }
+        std::lock_guard<std::mutex> guard(g_timer_lock);
+        g_timers.push_back(timer);
+    }
+    return 1;
+}
+
+uint32_t lv_host_pending_timers() {
+    std::lock_guard<std::mutex> guard(g_timer_lock);
+    return static_cast<uint32_t>(g_timers.size());
+}
+
+void lv_host_fail_async_calls(uint32_t count) {
+    g_async_failures.store(count, std::memory_order_relaxed);
+}
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host implementation of the NVS shim: one in-memory map per process.
+ */
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nvs.h>
+
+namespace {
+
+std::mutex                                     g_lock;
+std::vector<std::string>                       g_namespaces;   // Handle - 1 -> namespace.
+std::map<std::string, std::vector<uint8_t>>    g_blobs;        // "namespace/key" -> blob.
+
+std::string BlobName(nvs_handle_t handle, const char* key) {
+    return g_namespaces[handle - 1] + "/" + key;
+}
+
+} // namespace
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t /*mode*/, nvs_handle_t* out) {
+    std::lock_guard<std::mutex> guard(g_lock);
+    g_namespaces.emplace_back(name);
+    *out = static_cast<nvs_handle_t>(g_namespaces.size());
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* length) {
+    std::lock_guard<std::mutex> guard(g_lock);
+    auto it = g_blobs.find(BlobName(handle, key));
+    if (it == g_blobs.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out) {
+        if (*length < it->second.size()) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out, it->second.data(), it->second.size());
+    }
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    std::lock_guard<std::mutex> guard(g_lock);
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    g_blobs[BlobName(handle, key)].assign(bytes, bytes + length);
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t /*handle*/) {
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t /*handle*/) {}
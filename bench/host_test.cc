@@ -0,0 +1,405 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Host regression tests for lvgl-msg-bus, built against the same shims as
+ * the benchmark.  The LVGL "thread" is the test itself: deliveries run when
+ * a case calls Pump().
+ *
+ *   msgbus_host_test     (exit status 0 = all cases passed)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <lvgl.h>
+
+#include "lvgl_msg_bus/data_store.h"
+#include "lvgl_msg_bus/message_bus.h"
+#include "lvgl_msg_bus/mpsc_ring.h"
+#include "lvgl_msg_bus/subscription.h"
+
+using namespace msgbus;
+
+namespace {
+
+int g_failures = 0;
+
+#define EXPECT(cond)                                                   \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+            ++g_failures;                                              \
+        }                                                              \
+    } while (0)
+
+void Pump() {
+    for (int i = 0; i < 10; ++i) {
+        lv_timer_handler();
+        vTaskDelay(1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Cases
+// ---------------------------------------------------------------------------
+
+// A shed LvglLatest wake-up holds no in-flight slot and must not release one.
+void TestShedLatestWakeup() {
+    MessageBus bus;
+    BusConfig config;
+    config.max_inflight        = 4;
+    config.lvgl_shed_watermark = 1;
+    EXPECT(bus.Initialize(config) == ESP_OK);
+
+    std::atomic<int> async_calls{0};
+    std::atomic<int> latest_calls{0};
+    bus.Subscribe(1, [&](const Message&) { ++async_calls; }, DeliveryMode::LvglAsync);
+    bus.Subscribe(2, [&](const Message&) { ++latest_calls; }, DeliveryMode::LvglLatest, 0,
+                  DeliveryPriority::Low);
+
+    bus.Publish(1, 1);   // Queued: the watermark is reached.
+    bus.Publish(2, 1);   // Low LvglLatest wake-up: shed.
+    Pump();
+    EXPECT(async_calls == 1);
+    EXPECT(latest_calls == 0);
+    EXPECT(bus.GetBusStats().lvgl_shed == 1);
+    EXPECT(bus.GetBusStats().async_inflight == 0);
+
+    for (int i = 0; i < 3; ++i) {
+        bus.Publish(1, i);
+        Pump();
+    }
+    EXPECT(async_calls == 4);
+    EXPECT(bus.GetBusStats().async_inflight == 0);
+}
+
+// Typed publishes honour the configured max_data_size instead of kMaxSize.
+void TestTypedPublishSizeLimit() {
+    struct Big { uint8_t bytes[256]; };
+    struct Small { uint32_t value; };
+    constexpr TypedTopic<Big, 10> kBig;
+    constexpr TypedTopic<Small, 11> kSmall;
+
+    MessageBus bus;
+    BusConfig config;
+    config.max_data_size = 16;
+    EXPECT(bus.Initialize(config) == ESP_OK);
+
+    int big_calls = 0;
+    int small_calls = 0;
+    bus.Subscribe(kBig, [&](const Big&) { ++big_calls; }, DeliveryMode::Immediate);
+    bus.Subscribe(kSmall, [&](const Small&) { ++small_calls; }, DeliveryMode::Immediate);
+    bus.Publish(kBig, Big{});
+    bus.Publish(kSmall, Small{7});
+    EXPECT(big_calls == 0);
+    EXPECT(small_calls == 1);
+}
+
+// The debounced save runs in the store's task; a save that has to wait for
+// the store lock still completes once the lock is free.
+void TestPersistTaskSave() {
+    static const uint32_t kKeys[] = {1};
+    MessageBus bus;
+    EXPECT(bus.Initialize() == ESP_OK);
+
+    DataStoreConfig config;
+    config.bus               = &bus;
+    config.nvs_namespace     = "test_task";
+    config.persist_keys      = kKeys;
+    config.persist_key_count = 1;
+    config.persist_delay_ms  = 20;
+    {
+        DataStore store;
+        EXPECT(store.Initialize(config) == ESP_OK);
+        store.Set<int>(1, 42);
+        {
+            DataStore::View view = store.GetView(1);   // Holds the store lock.
+            EXPECT(view);
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+
+    DataStore restored;
+    EXPECT(restored.Initialize(config) == ESP_OK);
+    int value = 0;
+    EXPECT(restored.Get<int>(1, value) && value == 42);
+}
+
+// Snapshot records carry a 16-bit length; larger entries are refused up front.
+void TestPersistEntrySizeLimit() {
+    static const uint32_t kKeys[] = {1};
+    MessageBus bus;
+    EXPECT(bus.Initialize() == ESP_OK);
+
+    DataStoreConfig config;
+    config.bus               = &bus;
+    config.nvs_namespace     = "test_size";
+    config.persist_keys      = kKeys;
+    config.persist_key_count = 1;
+    config.max_entry_size    = DataStore::kMaxPersistedEntrySize + 1;
+    DataStore store;
+    EXPECT(store.Initialize(config) == ESP_ERR_INVALID_ARG);
+
+    config.max_entry_size = DataStore::kMaxPersistedEntrySize;
+    EXPECT(store.Initialize(config) == ESP_OK);
+}
+
+// A failure late in Initialize() undoes the earlier steps, workers included,
+// and leaves the bus ready for another attempt.
+void TestInitializeLateFailure() {
+    MessageBus bus;
+    BusConfig config;
+    config.worker_count    = 2;
+    config.isr_queue_depth = size_t(1) << 40;   // The ISR ring cannot be allocated.
+    const UBaseType_t tasks = uxTaskGetNumberOfTasks();
+    EXPECT(bus.Initialize(config) == ESP_ERR_NO_MEM);
+    EXPECT(!bus.IsInitialized());
+    EXPECT(uxTaskGetNumberOfTasks() == tasks);
+
+    config.isr_queue_depth = 0;
+    EXPECT(bus.Initialize(config) == ESP_OK);
+    EXPECT(uxTaskGetNumberOfTasks() == tasks + 2);
+    std::atomic<int> calls{0};
+    bus.Subscribe(1, [&](const Message&) { ++calls; }, DeliveryMode::Worker);
+    bus.Publish(1, 1);
+    for (int i = 0; i < 100 && calls == 0; ++i) {
+        vTaskDelay(1);
+    }
+    EXPECT(calls == 1);
+}
+
+// Replays taken while another task republishes the retained topic are
+// never torn.
+void TestRetainedReplayConsistent() {
+    struct Pair { uint32_t a[32]; uint32_t b[32]; };
+    MessageBus bus;
+    BusConfig config;
+    config.retained_topics     = 1;
+    config.retained_arena_size = sizeof(Pair);
+    EXPECT(bus.Initialize(config) == ESP_OK);
+    EXPECT(bus.Retain(1, sizeof(Pair)) == ESP_OK);
+
+    std::atomic<bool>     stop{false};
+    std::atomic<uint32_t> published{0};
+    std::thread publisher([&] {
+        Pair pair;
+        for (uint32_t n = 1; !stop; ++n) {
+            for (int i = 0; i < 32; ++i) {
+                pair.a[i] = pair.b[i] = n;
+            }
+            bus.Publish(1, &pair, sizeof(pair));
+            published = n;
+        }
+    });
+    while (published == 0) {
+        std::this_thread::yield();
+    }
+    int replays = 0;
+    int torn    = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const SubscriptionId id = bus.Subscribe(1, [&](const Message& msg) {
+            Pair pair;
+            memcpy(&pair, msg.data, sizeof(pair));
+            ++replays;
+            torn += memcmp(pair.a, pair.b, sizeof(pair.a)) != 0;
+        }, DeliveryMode::Immediate);
+        bus.Unsubscribe(id);
+    }
+    stop = true;
+    publisher.join();
+    EXPECT(replays > 0);
+    EXPECT(torn == 0);
+}
+
+// Racing pushes and pops never make the queue depth wrap, so nothing is
+// shed while the LVGL rings stay below the watermark.
+void TestShedBelowWatermark() {
+    MpscRing<uint32_t> ring;
+    EXPECT(ring.Init(4) == ESP_OK);
+    std::atomic<bool> stop{false};
+    std::thread churn([&] {
+        uint32_t value = 0;
+        while (!stop) {
+            ring.TryPush(value);
+            ring.TryPop(value);
+        }
+    });
+    // Long enough for the scheduler to preempt the reader between its loads.
+    size_t max_seen = 0;
+    const int64_t until = esp_timer_get_time() + 200000;
+    while (esp_timer_get_time() < until) {
+        for (int i = 0; i < 1000; ++i) {
+            max_seen = std::max(max_seen, ring.SizeApprox());
+        }
+    }
+    stop = true;
+    churn.join();
+    EXPECT(max_seen <= ring.Capacity());
+
+    MessageBus bus;
+    BusConfig config;
+    config.lvgl_shed_watermark = 8;
+    EXPECT(bus.Initialize(config) == ESP_OK);
+
+    // Two publishers, each waiting for its Normal + Low pair before the next
+    // one, keep at most 4 deliveries queued.
+    constexpr int kRounds = 500;
+    std::atomic<int> calls[2] = {{0}, {0}};
+    for (uint32_t p = 0; p < 2; ++p) {
+        std::atomic<int>& count = calls[p];
+        bus.Subscribe(2 * p + 1, [&count](const Message&) { ++count; },
+                      DeliveryMode::LvglAsync);
+        bus.Subscribe(2 * p + 2, [&count](const Message&) { ++count; },
+                      DeliveryMode::LvglAsync, 0, DeliveryPriority::Low);
+    }
+    const int64_t deadline = esp_timer_get_time() + 5000000;
+    auto publisher = [&](uint32_t p) {
+        for (int i = 0; i < kRounds; ++i) {
+            bus.Publish(2 * p + 1, i);
+            bus.Publish(2 * p + 2, i);
+            while (calls[p] < 2 * (i + 1) && bus.GetBusStats().lvgl_shed == 0 &&
+                   esp_timer_get_time() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+    };
+    std::thread a(publisher, 0);
+    std::thread b(publisher, 1);
+    while (calls[0] + calls[1] < 4 * kRounds && bus.GetBusStats().lvgl_shed == 0 &&
+           esp_timer_get_time() < deadline) {
+        lv_timer_handler();
+    }
+    a.join();
+    b.join();
+    EXPECT(calls[0] + calls[1] == 4 * kRounds);
+    EXPECT(bus.GetBusStats().lvgl_shed == 0);
+}
+
+// A frame LVGL refuses is released: nothing stays reserved or referenced.
+void TestPublishManyDispatchFailure() {
+    MessageBus bus;
+    BusConfig config;
+    config.max_inflight = 4;
+    EXPECT(bus.Initialize(config) == ESP_OK);
+    std::atomic<int> calls{0};
+    bus.Subscribe(1, [&](const Message&) { ++calls; }, DeliveryMode::LvglAsync);
+
+    const int a = 1;
+    const int b = 2;
+    const PublishEntry frame[] = {{1, &a, sizeof(a)}, {1, &b, sizeof(b)}};
+    lv_host_fail_async_calls(1);
+    bus.PublishMany(frame, 2);
+    Pump();
+    EXPECT(calls == 0);
+    EXPECT(bus.GetBusStats().async_inflight == 0);
+    EXPECT(bus.GetBusStats().alloc_failures == 2);
+
+    for (int i = 0; i < 3; ++i) {
+        bus.PublishMany(frame, 2);
+        Pump();
+    }
+    EXPECT(calls == 6);
+}
+
+// Unsubscribe() reports whether the subscription was removed.
+void TestUnsubscribeResult() {
+    MessageBus bus;
+    EXPECT(bus.Unsubscribe(1) == ESP_ERR_INVALID_STATE);
+    EXPECT(bus.Initialize() == ESP_OK);
+    int calls = 0;
+    const SubscriptionId id = bus.Subscribe(1, [&](const Message&) { ++calls; },
+                                            DeliveryMode::Immediate);
+    EXPECT(bus.Unsubscribe(kInvalidSubscription) == ESP_OK);
+    EXPECT(bus.Unsubscribe(id + 1) == ESP_ERR_NOT_FOUND);
+    bus.Publish(1, 1);
+    EXPECT(bus.Unsubscribe(id) == ESP_OK);
+    EXPECT(bus.Unsubscribe(id) == ESP_ERR_NOT_FOUND);
+    bus.Publish(1, 2);
+    EXPECT(calls == 1);
+}
+
+// A persistence start-up failure releases the coalescing state too, and a
+// second Initialize() starts from scratch.
+void TestStoreInitializeLateFailure() {
+    static const uint32_t kKeys[] = {1};
+    MessageBus bus;
+    EXPECT(bus.Initialize() == ESP_OK);
+
+    DataStoreConfig config;
+    config.bus               = &bus;
+    config.capacity          = 4;
+    config.notify            = NotifyMode::Coalesced;
+    config.nvs_namespace     = "test_fail";
+    config.persist_keys      = kKeys;
+    config.persist_key_count = 1;
+    DataStore store;
+    host_fail_task_creates(1);   // The persist task.
+    EXPECT(store.Initialize(config) == ESP_ERR_NO_MEM);
+
+    EXPECT(store.Initialize(config) == ESP_OK);
+    store.Set<int>(1, 5);
+    int value = 0;
+    EXPECT(store.Get<int>(1, value) && value == 5);
+    Pump();   // Run the coalesced flush before the store goes away.
+}
+
+// A watch on a store bound to its own bus is cancelled on that bus, not on
+// the default one.
+void TestWatchOnInstanceBus() {
+    MessageBus bus;
+    EXPECT(bus.Initialize() == ESP_OK);
+
+    DataStoreConfig config;
+    config.bus = &bus;
+    DataStore store;
+    EXPECT(store.Initialize(config) == ESP_OK);
+
+    int calls = 0;
+    SubscriptionGroup group;
+    group.Add(store.Watch(1, [&](uint32_t) { ++calls; }));
+    EXPECT(group.Size() == 1);
+    store.Set<int>(1, 1);
+    Pump();
+    EXPECT(calls == 1);
+
+    group.Clear();
+    store.Set<int>(1, 2);
+    Pump();
+    EXPECT(calls == 1);
+}
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+const Case kCases[] = {
+    {"shed LvglLatest wake-up", TestShedLatestWakeup},
+    {"typed publish size limit", TestTypedPublishSizeLimit},
+    {"debounced save in persist task", TestPersistTaskSave},
+    {"persisted entry size limit", TestPersistEntrySizeLimit},
+    {"Initialize late failure cleanup", TestInitializeLateFailure},
+    {"retained replay consistency", TestRetainedReplayConsistent},
+    {"no shedding below the watermark", TestShedBelowWatermark},
+    {"PublishMany dispatch failure", TestPublishManyDispatchFailure},
+    {"Unsubscribe result", TestUnsubscribeResult},
+    {"DataStore late failure cleanup", TestStoreInitializeLateFailure},
+    {"Watch on an instance bus", TestWatchOnInstanceBus},
+};
+
+} // namespace
+
+int main() {
+    for (const Case& c : kCases) {
+        const int before = g_failures;
+        c.run();
+        printf("%-40s %s\n", c.name, g_failures == before ? "ok" : "FAILED");
+    }
+    printf("%d failure(s)\n", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
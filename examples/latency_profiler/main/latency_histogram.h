@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * Lock-free latency histogram for the latency profiler example.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * @brief Fixed-bucket latency histogram (microseconds).
+ *
+ * 10 us buckets up to 2 ms, then 1 ms buckets up to 100 ms, plus an
+ * overflow bucket.  Record() is wait-free and may be called from several
+ * tasks at once.  Percentiles report the upper bound of the bucket holding
+ * the requested rank (capped at the maximum, which is exact).
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kFineStepUs   = 10;
+    static constexpr uint32_t kFineLimitUs  = 2000;
+    static constexpr uint32_t kCoarseStepUs = 1000;
+    static constexpr uint32_t kCoarseLimitUs = 100000;
+
+    static constexpr size_t kFineBuckets   = kFineLimitUs / kFineStepUs;
+    static constexpr size_t kCoarseBuckets = (kCoarseLimitUs - kFineLimitUs) / kCoarseStepUs;
+    static constexpr size_t kBuckets       = kFineBuckets + kCoarseBuckets + 1;
+
+    /** @brief Summary of one reporting interval. */
+    struct Summary {
+        uint32_t count;
+        uint32_t p50_us;
+        uint32_t p90_us;
+        uint32_t p99_us;
+        uint32_t max_us;
+    };
+
+    void Record(int64_t us) {
+        const uint32_t v = us < 0 ? 0 : static_cast<uint32_t>(us);
+        buckets_[BucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+        uint32_t cur = max_us_.load(std::memory_order_relaxed);
+        while (v > cur &&
+               !max_us_.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Summarise and clear the histogram.
+     *
+     * Samples recorded concurrently land in either this or the next interval.
+     */
+    Summary TakeSummary() {
+        uint32_t counts[kBuckets];
+        uint32_t total = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+            total += counts[i];
+        }
+        Summary s{};
+        s.count  = total;
+        s.max_us = max_us_.exchange(0, std::memory_order_relaxed);
+        s.p50_us = Percentile(counts, total, 50);
+        s.p90_us = Percentile(counts, total, 90);
+        s.p99_us = Percentile(counts, total, 99);
+        // Ranks in the overflow bucket are bounded by the exact maximum.
+        for (uint32_t* p : {&s.p50_us, &s.p90_us, &s.p99_us}) {
+            if (*p > s.max_us) {
+                *p = s.max_us;
+            }
+        }
+        return s;
+    }
+
+private:
+    static size_t BucketOf(uint32_t us) {
+        if (us < kFineLimitUs) {
+            return us / kFineStepUs;
+        }
+        if (us < kCoarseLimitUs) {
+            return kFineBuckets + (us - kFineLimitUs) / kCoarseStepUs;
+        }
+        return kBuckets - 1;
+    }
+
+    static uint32_t UpperBound(size_t bucket) {
+        if (bucket < kFineBuckets) {
+            return static_cast<uint32_t>((bucket + 1) * kFineStepUs);
+        }
+        if (bucket < kFineBuckets + kCoarseBuckets) {
+            return kFineLimitUs +
+                   static_cast<uint32_t>((bucket - kFineBuckets + 1) * kCoarseStepUs);
+        }
+        return UINT32_MAX;
+    }
+
+    static uint32_t Percentile(const uint32_t* counts, uint32_t total, uint32_t pct) {
+        if (total == 0) {
+            return 0;
+        }
+        // Rank of the sample at the requested percentile (1-based, rounded up).
+        const uint64_t rank = (static_cast<uint64_t>(total) * pct + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return UpperBound(i);
+            }
+        }
+        return UpperBound(kBuckets - 1);
+    }
+
+    std::atomic<uint32_t> buckets_[kBuckets] = {};
+    std::atomic<uint32_t> max_us_{0};
+};
+
+#endif // LATENCY_HISTOGRAM_H
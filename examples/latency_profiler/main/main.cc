@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * lvgl-msg-bus on-target latency profiler.
+ *
+ * Measures the delay from Publish() to the start of the subscriber callback
+ * while LVGL renders an animated scene into a virtual display:
+ *   1. One producer task per core publishes timestamped samples at
+ *      CONFIG_PROFILER_PUBLISH_RATE_HZ.
+ *   2. One subscriber per DeliveryMode records the delay into a histogram
+ *      per (mode, producer core).
+ *   3. Every CONFIG_PROFILER_REPORT_INTERVAL_S the p50 / p90 / p99 / max
+ *      latencies and the LVGL frame rate are logged.
+ *
+ * The display is not connected to a panel: the flush callback busy-waits
+ * CONFIG_PROFILER_FLUSH_US_PER_LINE per line to model the transfer, so the
+ * render load matches a real SPI screen without board-specific code.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <lvgl.h>
+
+#include "lvgl_msg_bus/message_bus.h"
+#include "latency_histogram.h"
+
+static const char* TAG = "Profiler";
+
+// ---- Parameters -------------------------------------------------------------
+
+static constexpr uint32_t    kProbeTopic      = 0x0100;
+static constexpr size_t      kModeCount       = 3;
+static constexpr UBaseType_t kProducerPrio    = 5;
+static constexpr UBaseType_t kLvglPrio        = 4;   // Below producers, like a typical UI task.
+static constexpr UBaseType_t kReporterPrio    = 1;
+
+static const msgbus::DeliveryMode kModes[kModeCount] = {
+    msgbus::DeliveryMode::Immediate,
+    msgbus::DeliveryMode::LvglAsync,
+    msgbus::DeliveryMode::LvglLatest,
+};
+static const char* const kModeNames[kModeCount] = {"Immediate", "LvglAsync", "LvglLatest"};
+
+/// Header of every published payload; the rest is padding up to
+/// CONFIG_PROFILER_PAYLOAD_SIZE.
+struct ProbeSample {
+    int64_t  publish_us;
+    uint32_t seq;
+    uint32_t core;
+};
+static_assert(sizeof(ProbeSample) <= CONFIG_PROFILER_PAYLOAD_SIZE,
+              "CONFIG_PROFILER_PAYLOAD_SIZE too small");
+
+// ---- Shared state -----------------------------------------------------------
+
+static LatencyHistogram      s_hist[kModeCount][portNUM_PROCESSORS];
+static std::atomic<uint32_t> s_published[portNUM_PROCESSORS];
+
+static std::atomic<uint32_t> s_frames{0};
+static std::atomic<uint32_t> s_render_total_us{0};
+static std::atomic<uint32_t> s_render_max_us{0};
+static int64_t               s_render_start_us = 0;   // LVGL task only.
+
+static lv_obj_t*         s_label = nullptr;
+static SemaphoreHandle_t s_lvgl_ready = nullptr;
+
+// ---- Virtual display --------------------------------------------------------
+
+static uint32_t tick_cb() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+static void flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* /*px_map*/) {
+    // Model the panel transfer instead of sending the pixels anywhere.
+    const int64_t until = esp_timer_get_time() +
+                          static_cast<int64_t>(lv_area_get_height(area)) *
+                          CONFIG_PROFILER_FLUSH_US_PER_LINE;
+    while (esp_timer_get_time() < until) {
+    }
+    lv_display_flush_ready(disp);
+}
+
+static void render_event_cb(lv_event_t* e) {
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_render_start_us = esp_timer_get_time();
+        return;
+    }
+    const uint32_t us = static_cast<uint32_t>(esp_timer_get_time() - s_render_start_us);
+    s_frames.fetch_add(1, std::memory_order_relaxed);
+    s_render_total_us.fetch_add(us, std::memory_order_relaxed);
+    if (us > s_render_max_us.load(std::memory_order_relaxed)) {
+        s_render_max_us.store(us, std::memory_order_relaxed);
+    }
+}
+
+static void anim_x_cb(void* obj, int32_t v) {
+    lv_obj_set_x(static_cast<lv_obj_t*>(obj), v);
+}
+
+static void create_scene() {
+    const int32_t hor = CONFIG_PROFILER_HOR_RES;
+    const int32_t ver = CONFIG_PROFILER_VER_RES;
+
+    lv_display_t* disp = lv_display_create(hor, ver);
+    const size_t buf_size = hor * (ver / 10) * (LV_COLOR_DEPTH / 8);
+    void* buf1 = heap_caps_malloc(buf_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    void* buf2 = heap_caps_malloc(buf_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    lv_display_set_buffers(disp, buf1, buf2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_START, nullptr);
+    lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_READY, nullptr);
+
+    // Objects sliding across the screen keep most of it dirty every frame.
+    lv_obj_t* screen = lv_screen_active();
+    const int32_t size = 32;
+    for (int i = 0; i < CONFIG_PROFILER_ANIMATED_OBJECTS; ++i) {
+        lv_obj_t* obj = lv_obj_create(screen);
+        lv_obj_set_size(obj, size, size);
+        lv_obj_set_y(obj, (i * (size + 4)) % (ver - size));
+        lv_obj_set_style_radius(obj, size / 2, 0);
+        lv_obj_set_style_bg_color(obj, lv_palette_main(static_cast<lv_palette_t>(i % LV_PALETTE_LAST)), 0);
+
+        lv_anim_t a;
+        lv_anim_init(&a);
+        lv_anim_set_var(&a, obj);
+        lv_anim_set_exec_cb(&a, anim_x_cb);
+        lv_anim_set_values(&a, 0, hor - size);
+        lv_anim_set_duration(&a, 800 + i * 70);
+        lv_anim_set_playback_duration(&a, 800 + i * 70);
+        lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+        lv_anim_start(&a);
+    }
+
+    // Updated by the LvglAsync subscriber, like a live value on a UI page.
+    s_label = lv_label_create(screen);
+    lv_obj_align(s_label, LV_ALIGN_BOTTOM_MID, 0, -4);
+}
+
+static void lvgl_task(void* /*arg*/) {
+    lv_init();
+    lv_tick_set_cb(tick_cb);
+    create_scene();
+    xSemaphoreGive(s_lvgl_ready);
+
+    while (true) {
+        const uint32_t wait = lv_timer_handler();
+        vTaskDelay(pdMS_TO_TICKS(std::clamp<uint32_t>(wait, 1, CONFIG_PROFILER_LVGL_MAX_SLEEP_MS)));
+    }
+}
+
+// ---- Producers / subscribers ------------------------------------------------
+
+static void producer_task(void* /*arg*/) {
+    auto& bus = msgbus::MessageBus::GetInstance();
+    const uint32_t   core   = xPortGetCoreID();
+    const TickType_t period = std::max<TickType_t>(
+        1, pdMS_TO_TICKS(1000 / CONFIG_PROFILER_PUBLISH_RATE_HZ));
+
+    uint8_t buf[CONFIG_PROFILER_PAYLOAD_SIZE] = {};
+    TickType_t last_wake = xTaskGetTickCount();
+    for (uint32_t seq = 0;; ++seq) {
+        const ProbeSample sample = {esp_timer_get_time(), seq, core};
+        memcpy(buf, &sample, sizeof(sample));
+        bus.Publish(kProbeTopic, buf, sizeof(buf));
+        s_published[core].fetch_add(1, std::memory_order_relaxed);
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
+
+static void subscribe_probes() {
+    auto& bus = msgbus::MessageBus::GetInstance();
+    for (size_t m = 0; m < kModeCount; ++m) {
+        bus.Subscribe(kProbeTopic, [m](const msgbus::Message& msg) {
+            // Sample the clock first so the callback's own work is excluded.
+            const int64_t now = esp_timer_get_time();
+            ProbeSample sample;
+            memcpy(&sample, msg.data, sizeof(sample));
+            s_hist[m][sample.core].Record(now - sample.publish_us);
+
+            if (kModes[m] == msgbus::DeliveryMode::LvglAsync && sample.seq % 16 == 0) {
+                lv_label_set_text_fmt(s_label, "core %lu seq %lu",
+                                      (unsigned long)sample.core,
+                                      (unsigned long)sample.seq);
+            }
+        }, kModes[m]);
+    }
+}
+
+// ---- Reporting --------------------------------------------------------------
+
+static void reporter_task(void* /*arg*/) {
+    const uint32_t interval_s = CONFIG_PROFILER_REPORT_INTERVAL_S;
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(interval_s * 1000));
+
+        const uint32_t frames   = s_frames.exchange(0, std::memory_order_relaxed);
+        const uint32_t total_us = s_render_total_us.exchange(0, std::memory_order_relaxed);
+        const uint32_t max_us   = s_render_max_us.exchange(0, std::memory_order_relaxed);
+        ESP_LOGI(TAG, "--- %lu s: %.1f fps, render avg %lu us, max %lu us",
+                 (unsigned long)interval_s, frames / static_cast<float>(interval_s),
+                 (unsigned long)(frames ? total_us / frames : 0), (unsigned long)max_us);
+
+        ESP_LOGI(TAG, "%-10s %4s %9s %9s %8s %8s %8s %8s", "mode", "core",
+                 "published", "delivered", "p50 us", "p90 us", "p99 us", "max us");
+        uint32_t published[portNUM_PROCESSORS];
+        for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+            published[core] = s_published[core].exchange(0, std::memory_order_relaxed);
+        }
+        for (size_t m = 0; m < kModeCount; ++m) {
+            for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+                const LatencyHistogram::Summary s = s_hist[m][core].TakeSummary();
+                ESP_LOGI(TAG, "%-10s %4d %9lu %9lu %8lu %8lu %8lu %8lu",
+                         kModeNames[m], core, (unsigned long)published[core],
+                         (unsigned long)s.count, (unsigned long)s.p50_us,
+                         (unsigned long)s.p90_us, (unsigned long)s.p99_us,
+                         (unsigned long)s.max_us);
+            }
+        }
+
+#if LVGL_MSG_BUS_STATS
+        msgbus::MessageBus::GetInstance().DumpStats();
+#endif
+    }
+}
+
+// ---- Main -------------------------------------------------------------------
+
+extern "C" void app_main(void) {
+    msgbus::MessageBus::GetInstance().Initialize();
+
+    // LVGL is initialised and driven by a single task on its own core.
+    s_lvgl_ready = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(lvgl_task, "lvgl", 8192, nullptr, kLvglPrio, nullptr,
+                            CONFIG_PROFILER_LVGL_CORE);
+    xSemaphoreTake(s_lvgl_ready, portMAX_DELAY);
+
+    subscribe_probes();
+
+    for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+        xTaskCreatePinnedToCore(producer_task, "producer", 4096, nullptr,
+                                kProducerPrio, nullptr, core);
+    }
+    xTaskCreate(reporter_task, "reporter", 4096, nullptr, kReporterPrio, nullptr);
+
+    ESP_LOGI(TAG, "Profiling: %d Hz per core, %d-byte payload, LVGL on core %d",
+             CONFIG_PROFILER_PUBLISH_RATE_HZ, CONFIG_PROFILER_PAYLOAD_SIZE,
+             CONFIG_PROFILER_LVGL_CORE);
+}
@@ -8,6 +8,8 @@
 #ifndef LVGL_MSG_BUS_DATA_STORE_H
 #define LVGL_MSG_BUS_DATA_STORE_H
 
+#include <atomic>
+#include <initializer_list>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -16,10 +18,14 @@
 #include <vector>
 
 #include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
 
 #include "lvgl_msg_bus/message_bus.h"
+#include "lvgl_msg_bus/subscription.h"
 
 namespace msgbus {
 
@@ -27,11 +33,55 @@ namespace msgbus {
 // DataStore configuration
 // ---------------------------------------------------------------------------
 
+/**
+ * @brief When DataStore change notifications are sent.
+ *
+ * - Immediate : every changing Set() publishes its notification right away.
+ * - Coalesced : a changing Set() only marks the key dirty.  A flush in the
+ *               LVGL task then publishes one notification per dirty key with
+ *               its latest value, at most once per
+ *               DataStoreConfig::flush_interval_ms (0 = every
+ *               lv_timer_handler() pass, i.e. once per refresh).
+ */
+enum class NotifyMode {
+    Immediate,
+    Coalesced,
+};
+
 /**
  * @brief Optional tunables for DataStore::Initialize().
+ *
+ * With @c capacity > 0 the store is flat: Initialize() reserves one arena of
+ * @c capacity fixed slots of @c max_entry_size bytes plus an open-addressing
+ * key index, and SetRaw() never allocates afterwards.  A Set() of a new key
+ * fails (with a warning) once all slots are in use.  With @c capacity == 0
+ * every key gets its own heap node and buffer, with no limit on the count.
  */
 struct DataStoreConfig {
-    size_t max_entry_size = 256;  ///< Maximum value size in bytes.
+    size_t   max_entry_size = 256;  ///< Maximum value size in bytes (flat: slot size).
+    size_t   capacity       = 0;    ///< Flat mode: number of keys to reserve (0 = heap per key).
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;  ///< heap_caps for the flat arena.
+    NotifyMode notify            = NotifyMode::Immediate;
+    uint32_t   flush_interval_ms = 0;   ///< Coalesced: minimum time between flushes.
+    MessageBus* bus              = nullptr;   ///< Bus for notifications (nullptr = MessageBus::GetInstance()).
+
+    // Persistence (see DataStore::Save()).
+    const char*     nvs_namespace     = nullptr;  ///< NVS namespace of the snapshot (nullptr = not persisted; max_entry_size <= 65535).
+    const uint32_t* persist_keys      = nullptr;  ///< Keys saved to and restored from NVS.
+    size_t          persist_key_count = 0;
+    uint32_t        persist_delay_ms  = 2000;     ///< Save this long after the first unsaved change.
+    UBaseType_t     persist_task_priority = 2;    ///< Task that runs the debounced NVS writes.
+    BaseType_t      persist_task_core     = tskNO_AFFINITY;
+    uint32_t        persist_task_stack    = 4096;
+};
+
+/**
+ * @brief One write of DataStore::SetMany().
+ */
+struct StoreWrite {
+    uint32_t    key;
+    const void* data;
+    size_t      size;   ///< Value size in bytes.
 };
 
 // ---------------------------------------------------------------------------
@@ -52,7 +102,18 @@ struct DataStoreConfig {
  *
  * Thread safety
  * -------------
- * All public methods are safe to call from any FreeRTOS task.
+ * All public methods are safe to call from any FreeRTOS task.  Writers are
+ * serialised by a mutex.  In flat mode (DataStoreConfig::capacity > 0)
+ * GetRaw() / Contains() take no lock: each slot is a seqlock, so a reader
+ * copies the value and retries only if a write overlapped the copy.
+ *
+ * Versions
+ * --------
+ * Every change (a Set() that alters a value, or a Remove()) advances the
+ * store version by one, and the changed key records the new version.  Key
+ * versions are therefore comparable across keys and never go backwards; 0
+ * means "never seen".  Version() is a single atomic load, so code that polls
+ * can skip all work while nothing changed.
  */
 class DataStore {
 public:
@@ -65,15 +126,88 @@ public:
      */
     static constexpr uint32_t kDefaultTopicBase = 0x8000;
 
+    /// Largest @c max_entry_size accepted with persistence on (the snapshot
+    /// stores each value length in 16 bits).
+    static constexpr size_t kMaxPersistedEntrySize = 0xFFFF;
+
+    /**
+     * @brief Scoped, in-place read access to one value (see GetView()).
+     *
+     * Holds the store mutex for its lifetime, so data() stays valid and
+     * unchanged until the View is destroyed.  Writers on other tasks wait
+     * meanwhile, so keep views short.
+     *
+     * The store mutex is not recursive.  While a View is alive, the same
+     * task must not call Set(), SetRaw(), SetMany(), Remove(), Save(),
+     * GetView(), or, in map mode, Get(), GetRaw(), GetRawIfNewer(),
+     * GetVersion(), GetSize() and Contains(): each waits for the mutex,
+     * times out after one second and fails.  Flat-mode reads do not lock
+     * while the View blocks writers, so they are safe.
+     */
+    class View {
+    public:
+        View() = default;
+        View(View&& other) noexcept
+            : mutex_(other.mutex_), data_(other.data_), size_(other.size_) {
+            other.mutex_ = nullptr;
+            other.data_  = nullptr;
+            other.size_  = 0;
+        }
+        View& operator=(View&& other) noexcept {
+            if (this != &other) {
+                Release();
+                mutex_ = other.mutex_;
+                data_  = other.data_;
+                size_  = other.size_;
+                other.mutex_ = nullptr;
+                other.data_  = nullptr;
+                other.size_  = 0;
+            }
+            return *this;
+        }
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+        ~View() { Release(); }
+
+        const uint8_t* data() const { return data_; }
+        size_t         size() const { return size_; }
+        /** @brief True if the key was found. */
+        explicit operator bool() const { return data_ != nullptr; }
+
+    private:
+        friend class DataStore;
+        View(SemaphoreHandle_t mutex, const uint8_t* data, size_t size)
+            : mutex_(mutex), data_(data), size_(size) {}
+        void Release() {
+            if (mutex_) {
+                xSemaphoreGive(mutex_);
+                mutex_ = nullptr;
+            }
+        }
+
+        SemaphoreHandle_t mutex_ = nullptr;
+        const uint8_t*    data_  = nullptr;
+        size_t            size_  = 0;
+    };
+
     /**
-     * @brief Access the singleton.
+     * @brief Access the default store.
+     *
+     * Further stores can be constructed, e.g. one per MessageBus instance
+     * (DataStoreConfig::bus); each must outlive its watchers.
      */
     static DataStore& GetInstance();
 
+    DataStore() = default;
+    ~DataStore();
+    DataStore(const DataStore&) = delete;
+    DataStore& operator=(const DataStore&) = delete;
+
     /**
      * @brief One-time initialisation.
      * @param config     Optional tunables.
      * @param topic_base Base added to each key to form the MessageBus topic.
+     *                   Coalesced mode also uses @c topic_base - 1 for change sets.
      * @return ESP_OK on success.
      */
     esp_err_t Initialize(const DataStoreConfig& config = {},
@@ -102,58 +236,284 @@ public:
         return GetRaw(key, &out, sizeof(T));
     }
 
+    /**
+     * @brief Read a value only if it changed since @p version.
+     *
+     * Copies the value and sets @p version to the key's version when that is
+     * newer than @p version; otherwise leaves @p out untouched.  Returns
+     * without locking or copying when nothing in the store changed since
+     * @p version.
+     *
+     * @code
+     * static uint32_t seen = 0;
+     * int16_t temp;
+     * if (store.GetIfNewer(Key::Temperature, seen, temp)) {
+     *     RedrawGauge(temp);
+     * }
+     * @endcode
+     *
+     * @return @c true if @p out was updated.
+     */
+    template <typename T>
+    bool GetIfNewer(uint32_t key, uint32_t& version, T& out) const {
+        return GetRawIfNewer(key, version, &out, sizeof(T));
+    }
+
     /**
      * @brief Watch a key for changes.  The callback runs in the LVGL thread.
      *
      * This is a convenience wrapper around
      * @c MessageBus::Subscribe(topic_base + key, ...).
      *
-     * @return SubscriptionId for later Unwatch().
+     * @return A Subscription bound to the store's bus (see GetBus()); the
+     *         watch ends when it is destroyed or reset.  Empty on error.
      */
-    SubscriptionId Watch(uint32_t key,
-                         std::function<void(uint32_t key)> callback);
+    Subscription Watch(uint32_t key,
+                       std::function<void(uint32_t key)> callback);
 
     /**
-     * @brief Remove a watch previously registered with Watch().
+     * @brief Watch every key in [@p first_key, @p last_key] with one
+     *        subscription (MessageBus::SubscribeRange()).  The callback
+     *        receives the key that changed and runs in the LVGL thread.
+     *
+     * @return As for Watch().
+     */
+    Subscription WatchRange(uint32_t first_key, uint32_t last_key,
+                            std::function<void(uint32_t key)> callback);
+
+    /**
+     * @brief Receive the keys notified by each Coalesced flush as one batch.
+     *
+     * The callback runs in the LVGL task once per flush, after the per-key
+     * notifications, with the keys that changed since the previous flush.
+     * The array is only valid during the call.  Requires
+     * NotifyMode::Coalesced.
+     *
+     * @return As for Watch().
      */
-    void Unwatch(SubscriptionId id);
+    Subscription WatchChanges(
+        std::function<void(const uint32_t* keys, size_t count)> callback);
+
+    /**
+     * @brief Remove a watch by id, for callers that took it out of the
+     *        Subscription returned by Watch() (Subscription::Release()).
+     * @return The result of MessageBus::Unsubscribe().
+     */
+    esp_err_t Unwatch(SubscriptionId id);
 
     /**
      * @brief Check if a key exists in the store.
      */
     bool Contains(uint32_t key) const;
 
+    /**
+     * @brief Size in bytes of @p key's value, or 0 if it is not stored.
+     *
+     * Lock-free in flat mode.  Use it to size the buffer for GetRaw() when
+     * values vary in length.
+     */
+    size_t GetSize(uint32_t key) const;
+
+    /**
+     * @brief Read a value in place, without copying it.
+     *
+     * @code
+     * if (auto view = store.GetView(Key::WifiSsid)) {
+     *     lv_label_set_text_fmt(label, "%.*s", (int)view.size(), (const char*)view.data());
+     * }
+     * @endcode
+     *
+     * See View for the calls that must not be made while it is alive.
+     *
+     * @return A View holding the store lock; empty if the key is not stored.
+     */
+    View GetView(uint32_t key) const;
+
     /**
      * @brief Remove a key and its value from the store.
      */
     void Remove(uint32_t key);
 
+    /**
+     * @brief Store version: the number of changes so far.  Lock-free.
+     */
+    uint32_t Version() const { return version_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Version of @p key's current value, or 0 if it is not stored.
+     *
+     * Lock-free in flat mode; takes the store mutex otherwise.
+     */
+    uint32_t GetVersion(uint32_t key) const;
+
     /** @brief Return true if Initialize() has been called. */
     bool IsInitialized() const { return initialized_; }
 
     /** @brief Topic base currently in use. */
     uint32_t GetTopicBase() const { return topic_base_; }
 
+    /** @brief Bus that carries the notifications (DataStoreConfig::bus). */
+    MessageBus& GetBus() const { return *bus_; }
+
     // ---- raw API (for variable-size data) -----------------------------------
 
     void SetRaw(uint32_t key, const void* data, size_t size);
     bool GetRaw(uint32_t key, void* out, size_t size) const;
+    bool GetRawIfNewer(uint32_t key, uint32_t& version, void* out, size_t size) const;
 
-private:
-    DataStore() = default;
-    ~DataStore();
-    DataStore(const DataStore&) = delete;
-    DataStore& operator=(const DataStore&) = delete;
+    /**
+     * @brief Apply several writes as one update.
+     *
+     * All writes are applied under a single lock, in order, so readers never
+     * see only part of them.  Each is compared with the stored value like
+     * SetRaw(), and the notifications of the changed keys are published
+     * together via MessageBus::PublishMany() once the lock is released (in
+     * NotifyMode::Coalesced they simply join the next flush).  Invalid or
+     * oversized writes are skipped with a warning.
+     *
+     * @code
+     * store.SetMany({{Key::BatteryPct, &pct, sizeof(pct)},
+     *                {Key::BatteryMv,  &mv,  sizeof(mv)},
+     *                {Key::Charging,   &chg, sizeof(chg)}});
+     * @endcode
+     */
+    void SetMany(const StoreWrite* writes, size_t count);
+    void SetMany(std::initializer_list<StoreWrite> writes) {
+        SetMany(writes.begin(), writes.size());
+    }
+
+    /**
+     * @brief Write the persisted keys to NVS now.
+     *
+     * With @c DataStoreConfig::nvs_namespace set, the values of
+     * @c persist_keys are saved as one CRC-checked blob and Initialize()
+     * restores them with a single read, before anyone can watch them.
+     * Changes are saved automatically @c persist_delay_ms after the first
+     * unsaved one, so a burst of updates costs one flash write.  Those saves
+     * run in a store-owned task, never in the esp_timer task.  Call Save()
+     * before a planned reboot or deep sleep.  The application must have
+     * called nvs_flash_init().
+     *
+     * @return ESP_OK (also when nothing changed), ESP_ERR_INVALID_STATE if
+     *         persistence is off, or the NVS error.
+     */
+    esp_err_t Save();
 
+private:
     struct Entry {
         std::vector<uint8_t> data;
+        uint32_t             version = 0;     ///< Store version of the last change.
+        bool                 dirty = false;   ///< Coalesced: queued in pending_.
+    };
+
+    /// Payload of the change-set notification (valid during delivery only).
+    struct ChangeSet {
+        const uint32_t* keys;
+        size_t          count;
+    };
+
+    /// Flat mode: key -> slot index (open addressing, linear probing).
+    /// Read without the lock, so both fields are atomics.
+    struct IndexEntry {
+        std::atomic<uint32_t> key;
+        std::atomic<uint32_t> slot;   ///< kEmptySlot when unused.
+    };
+
+    /// Flat mode: header of one arena slot, followed by the value bytes.
+    struct FlatSlot {
+        std::atomic<uint32_t> seq{0};    ///< Seqlock: odd while a write is in progress.
+        std::atomic<uint32_t> size{0};
+        std::atomic<uint32_t> version{0};   ///< Store version of the last change.
+        bool                  dirty = false;   ///< Coalesced: queued in pending_ (mutex_).
+        uint8_t* Data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    /// Outcome of one lock-free read attempt.
+    enum class ReadResult {
+        Ok,
+        Missing,
+        Unchanged,   ///< Not newer than the caller's version; nothing copied.
+        Retry,
     };
 
+    static constexpr uint32_t kEmptySlot   = UINT32_MAX;
+    static constexpr int      kReadRetries = 4;   ///< Seqlock attempts before locking.
+
+    /// Stops the persist task and frees everything Initialize() set up.
+    void        ReleaseResources();
+    esp_err_t   InitFlat();
+    void        ReleaseFlat();
+    IndexEntry* FindIndex(uint32_t key) const;
+    void        EraseIndex(size_t pos);
+    size_t      HomeOf(uint32_t key) const { return (key * 2654435761u) & index_mask_; }
+    FlatSlot*   SlotAt(uint32_t slot) const {
+        return reinterpret_cast<FlatSlot*>(arena_ + slot * slot_stride_);
+    }
+    bool        CheckSize(uint32_t key, const void* data, size_t size) const;
+    bool        StoreLocked(uint32_t key, const void* data, size_t size);
+    bool        ApplyLocked(uint32_t key, const void* data, size_t size);
+    bool        PeekLocked(uint32_t key, const uint8_t*& data, size_t& size) const;
+    bool        SetFlat(uint32_t key, const void* data, size_t size, uint32_t version);
+    void        WriteSlot(FlatSlot* slot, const void* data, size_t size, uint32_t version);
+    void        BeginIndexWrite();
+    void        EndIndexWrite();
+    ReadResult  TryReadFlat(uint32_t key, void* out, size_t size,
+                            uint32_t* version = nullptr,
+                            size_t* stored_size = nullptr) const;
+    ReadResult  ReadFlat(uint32_t key, void* out, size_t size,
+                         uint32_t* version = nullptr,
+                         size_t* stored_size = nullptr) const;
+
+    bool*       DirtyFlag(uint32_t key);
+    bool        TakeDirty(uint32_t key, size_t& size);
+    void        Flush();
+    uint32_t    ChangeSetTopic() const { return topic_base_ - 1; }
+    /// Coalesced flushes already run in the LVGL task, so watchers are called in place.
+    DeliveryMode WatchMode() const {
+        return config_.notify == NotifyMode::Coalesced ? DeliveryMode::Immediate
+                                                       : DeliveryMode::LvglAsync;
+    }
+    static void FlushCb(void* user_data);
+    static void FlushTimerCb(lv_timer_t* timer);
+
+    esp_err_t   InitPersistence();
+    bool        IsPersisted(uint32_t key) const;
+    void        Restore();
+    void        SchedulePersist();
+    static void PersistTimerCb(void* arg);
+    static void PersistTask(void* arg);
+
     bool                          initialized_ = false;
     DataStoreConfig               config_{};
     uint32_t                      topic_base_ = kDefaultTopicBase;
+    MessageBus*                   bus_ = &MessageBus::GetInstance();
     mutable SemaphoreHandle_t     mutex_ = nullptr;
-    std::map<uint32_t, Entry>     entries_;
+    std::map<uint32_t, Entry>     entries_;          ///< capacity == 0 only.
+    std::atomic<uint32_t>         version_{0};       ///< Bumped by every change (mutex_).
+
+    // Flat mode (capacity > 0); all allocated in Initialize().
+    uint8_t*                      arena_       = nullptr;   ///< capacity slots.
+    size_t                        slot_stride_ = 0;
+    IndexEntry*                   index_       = nullptr;   ///< index_mask_ + 1 entries.
+    size_t                        index_mask_  = 0;
+    uint32_t*                     free_slots_  = nullptr;   ///< Stack of unused slots.
+    size_t                        free_count_  = 0;
+    std::atomic<uint32_t>         index_seq_{0};            ///< Seqlock over index_ changes.
+
+    // Coalesced notifications.
+    std::vector<uint32_t>         pending_;                 ///< Dirty keys, in change order (mutex_).
+    std::vector<uint32_t>         flushing_;                ///< Keys of the running flush (LVGL task).
+    uint8_t*                      scratch_ = nullptr;       ///< Value copy for the flush.
+    std::atomic<bool>             flush_scheduled_{false};
+    uint32_t                      last_flush_tick_ = 0;
+
+    // Persistence.
+    std::vector<uint32_t>         persist_keys_;            ///< Sorted DataStoreConfig::persist_keys.
+    esp_timer_handle_t            persist_timer_ = nullptr;
+    TaskHandle_t                  persist_task_  = nullptr;   ///< Runs the debounced Save().
+    SemaphoreHandle_t             persist_mutex_ = nullptr;   ///< Serialises Save().
+    std::atomic<bool>             persist_dirty_{false};    ///< A persisted key changed since the last Save().
+    std::atomic<bool>             persist_armed_{false};    ///< persist_timer_ is running.
 };
 
 } // namespace msgbus
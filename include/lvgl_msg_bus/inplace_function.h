@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * lvgl-msg-bus — Non-allocating, fixed-capacity callable wrapper.
+ */
+
+#ifndef LVGL_MSG_BUS_INPLACE_FUNCTION_H
+#define LVGL_MSG_BUS_INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace msgbus {
+
+template <typename Signature, size_t Capacity>
+class InplaceFunction;
+
+/**
+ * @brief Move-only std::function replacement that never allocates.
+ *
+ * The callable is stored in an inline buffer of @p Capacity bytes; a callable
+ * that does not fit (or needs stricter alignment than a pointer / double) is
+ * rejected at compile time instead of silently going to the heap.  Calling
+ * an empty InplaceFunction is undefined — test it with @c operator bool.
+ *
+ * @tparam Capacity  Inline storage in bytes.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+    static constexpr size_t kCapacity = Capacity;
+
+    InplaceFunction() = default;
+    InplaceFunction(std::nullptr_t) {}
+
+    template <typename F, typename D = typename std::decay<F>::type,
+              typename = typename std::enable_if<
+                  !std::is_same<D, InplaceFunction>::value &&
+                  std::is_invocable_r<R, D&, Args...>::value>::type>
+    InplaceFunction(F&& f) {
+        static_assert(sizeof(D) <= Capacity,
+                      "Callable too large for InplaceFunction; capture less "
+                      "or raise the capacity");
+        static_assert(alignof(D) <= alignof(Storage),
+                      "Callable over-aligned for InplaceFunction");
+        static_assert(std::is_nothrow_move_constructible<D>::value,
+                      "InplaceFunction callables must be nothrow-movable");
+        if constexpr (std::is_pointer<typename std::remove_reference<F>::type>::value) {
+            if (!f) {
+                return;   // Null function pointer: stay empty.
+            }
+        }
+        ::new (static_cast<void*>(&storage_)) D(std::forward<F>(f));
+        ops_ = &OpsFor<D>::kOps;
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept { MoveFrom(other); }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    ~InplaceFunction() { Reset(); }
+
+    R operator()(Args... args) const {
+        return ops_->invoke(&storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    /** @brief Destroy the stored callable (idempotent). */
+    void Reset() {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    using Storage = typename std::aligned_storage<
+        Capacity, alignof(std::max_align_t) < 8 ? alignof(std::max_align_t) : 8>::type;
+
+    /// Type-erased operations on the stored callable.
+    struct Ops {
+        R    (*invoke)(void* self, Args&&... args);
+        void (*move)(void* dst, void* src);   ///< Move-construct into @p dst, destroy @p src.
+        void (*destroy)(void* self);
+    };
+
+    template <typename D>
+    struct OpsFor {
+        static R Invoke(void* self, Args&&... args) {
+            return (*static_cast<D*>(self))(std::forward<Args>(args)...);
+        }
+        static void Move(void* dst, void* src) {
+            ::new (dst) D(std::move(*static_cast<D*>(src)));
+            static_cast<D*>(src)->~D();
+        }
+        static void Destroy(void* self) { static_cast<D*>(self)->~D(); }
+
+        static constexpr Ops kOps = {&Invoke, &Move, &Destroy};
+    };
+
+    void MoveFrom(InplaceFunction& other) {
+        if (other.ops_) {
+            other.ops_->move(&storage_, &other.storage_);
+            ops_       = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    mutable Storage storage_;   // Callables may be mutable, as with std::function.
+    const Ops*      ops_ = nullptr;
+};
+
+} // namespace msgbus
+
+#endif // LVGL_MSG_BUS_INPLACE_FUNCTION_H
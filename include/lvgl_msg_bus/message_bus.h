@@ -8,17 +8,43 @@
 #ifndef LVGL_MSG_BUS_MESSAGE_BUS_H
 #define LVGL_MSG_BUS_MESSAGE_BUS_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
-#include <functional>
-#include <vector>
+#include <type_traits>
+#include <utility>
 
 #include <esp_err.h>
 #include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <lvgl.h>
 
+#include "lvgl_msg_bus/inplace_function.h"
+#include "lvgl_msg_bus/mpsc_ring.h"
+#include "lvgl_msg_bus/payload_pool.h"
+
+#if defined(CONFIG_MSGBUS_ENABLE_STATS) && CONFIG_MSGBUS_ENABLE_STATS
+#define LVGL_MSG_BUS_STATS 1
+#else
+#define LVGL_MSG_BUS_STATS 0
+#endif
+
+#if defined(CONFIG_MSGBUS_ENABLE_TRACE) && CONFIG_MSGBUS_ENABLE_TRACE
+#define LVGL_MSG_BUS_TRACE 1
+#else
+#define LVGL_MSG_BUS_TRACE 0
+#endif
+
+#if defined(CONFIG_MSGBUS_CALLBACK_WORDS)
+#define LVGL_MSG_BUS_CALLBACK_WORDS CONFIG_MSGBUS_CALLBACK_WORDS
+#else
+#define LVGL_MSG_BUS_CALLBACK_WORDS 6
+#endif
+
 namespace msgbus {
 
 // ---------------------------------------------------------------------------
@@ -28,12 +54,79 @@ namespace msgbus {
 /**
  * @brief How a subscriber callback is invoked.
  *
- * - Immediate : called synchronously in the publisher's thread.
- * - LvglAsync : dispatched to the LVGL thread via lv_async_call().
+ * - Immediate  : called synchronously in the publisher's thread.
+ * - LvglAsync  : dispatched to the LVGL thread via lv_async_call().
+ * - LvglLatest : dispatched to the LVGL thread, conflated — the subscriber
+ *                holds a single pending slot and a newer message replaces a
+ *                queued one, so at most one delivery is in flight and the
+ *                callback always sees the newest value.
+ * - Worker     : run by a task of the bus's worker pool (BusConfig::
+ *                worker_count), for heavy non-UI subscribers such as logging
+ *                or uplinks.  Each subscriber is served by one worker, so its
+ *                callbacks never overlap and see messages in publish order.
  */
 enum class DeliveryMode {
     Immediate,
     LvglAsync,
+    LvglLatest,
+    Worker,
+};
+
+/**
+ * @brief How LvglAsync deliveries reach the LVGL task.
+ *
+ * - PerMessage : one @c lv_async_call() (one-shot LVGL timer) per delivery.
+ * - Batched    : deliveries are pushed onto a lock-free ring owned by the bus
+ *                and drained in batches; only the first delivery of a burst
+ *                costs an @c lv_async_call().
+ */
+enum class LvglDispatch {
+    PerMessage,
+    Batched,
+};
+
+/**
+ * @brief Drain order of a subscriber's LVGL-thread deliveries (Batched only).
+ *
+ * Each class has its own dispatch ring and the drain always empties the
+ * higher classes first.
+ *
+ * - High   : drained before anything else and exempt from
+ *            @c lvgl_batch_size / @c lvgl_drain_budget_us (alarms, touch
+ *            feedback).  Keep it rare — a High flood delays rendering.
+ * - Normal : default.
+ * - Low    : drained last; shed once @c BusConfig::lvgl_shed_watermark
+ *            deliveries are queued (telemetry, statistics).
+ *
+ * With LvglDispatch::PerMessage deliveries stay in lv_async_call() order.
+ */
+enum class DeliveryPriority {
+    High,
+    Normal,
+    Low,
+};
+
+/**
+ * @brief What happens to an LvglAsync or Worker delivery that would exceed an
+ *        in-flight cap (SubscribeOptions::max_inflight, the Worker queue
+ *        depth or BusConfig::max_inflight).
+ *
+ * - DropNewest : discard the new message.
+ * - DropOldest : discard the subscriber's oldest queued message to make room.
+ * - Block      : wait up to @c block_timeout_ms in the publisher for room,
+ *                then discard.  Never use for publishers running in the LVGL
+ *                task — it is the one that makes room.
+ * - Conflate   : discard everything the subscriber has queued and keep only
+ *                the new message.
+ *
+ * DropOldest and Conflate act on the subscriber's own queue; when the bus-wide
+ * cap is the one reached they behave like DropNewest.
+ */
+enum class OverflowPolicy {
+    DropNewest,
+    DropOldest,
+    Block,
+    Conflate,
 };
 
 // ---------------------------------------------------------------------------
@@ -44,8 +137,9 @@ enum class DeliveryMode {
  * @brief Read-only message delivered to subscribers.
  *
  * The @c data pointer is valid only for the duration of the callback.
- * For @c LvglAsync delivery the bus makes an internal copy that is freed
- * automatically after the callback returns.
+ * For LVGL-thread delivery the bus makes one internal copy per publish,
+ * shared by all async subscribers and freed automatically after the last
+ * callback returns.
  */
 struct Message {
     uint32_t    topic;      ///< Topic identifier.
@@ -66,12 +160,109 @@ struct Message {
 // Callback type and subscription handle
 // ---------------------------------------------------------------------------
 
-using MessageCallback  = std::function<void(const Message&)>;
+/// Inline capture space of a MessageCallback (CONFIG_MSGBUS_CALLBACK_WORDS pointers).
+static constexpr size_t kCallbackCapacity = LVGL_MSG_BUS_CALLBACK_WORDS * sizeof(void*);
+
+/// Subscriber callback.  Move-only and never allocates: a lambda capturing
+/// more than kCallbackCapacity bytes fails to compile.
+using MessageCallback  = InplaceFunction<void(const Message&), kCallbackCapacity>;
 using SubscriptionId   = uint32_t;
 
 /// Reserved value that represents "no subscription".
 static constexpr SubscriptionId kInvalidSubscription = 0;
 
+// ---------------------------------------------------------------------------
+// Statistics (CONFIG_MSGBUS_ENABLE_STATS)
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Counters for one topic, as returned by MessageBus::GetTopicStats().
+ */
+struct TopicStats {
+    uint32_t topic;
+    uint32_t publishes;     ///< Publish() / Commit() / ISR publishes.
+    uint64_t bytes;         ///< Payload bytes published.
+    uint32_t delivered;     ///< Callbacks executed.
+    uint32_t throttled;     ///< Deliveries skipped by min_interval_ms.
+    uint32_t dropped;       ///< Deliveries lost (allocation failure, overload).
+    uint32_t peak_fanout;   ///< Most subscribers reached by a single publish.
+};
+
+/**
+ * @brief Callback timing for one live subscription (microseconds).
+ *
+ * Latency is measured for LVGL-thread deliveries only, from the publish to
+ * the start of the callback.
+ */
+struct SubscriberStats {
+    SubscriptionId id;
+    uint32_t       topic;
+    DeliveryMode   mode;
+    uint32_t       calls;
+    uint32_t       exec_min_us;
+    uint32_t       exec_avg_us;
+    uint32_t       exec_max_us;
+    uint32_t       latency_min_us;
+    uint32_t       latency_avg_us;
+    uint32_t       latency_max_us;
+    uint32_t       dropped;   ///< Deliveries discarded by the overflow policy.
+};
+
+/**
+ * @brief Bus-wide counters, as returned by MessageBus::GetBusStats().
+ */
+struct BusStats {
+    uint32_t alloc_failures;       ///< "Async alloc failed" occurrences.
+    uint32_t pool_heap_fallbacks;  ///< Payload pool blocks served from the heap.
+    uint32_t pool_failures;        ///< Payload pool allocations that failed.
+    uint32_t loan_failures;        ///< LoanBuffer() allocations that failed.
+    uint32_t lvgl_shed;            ///< Low-priority deliveries shed at the watermark.
+    uint32_t async_inflight;       ///< LvglAsync / Worker deliveries currently queued.
+    uint32_t dropped_newest;       ///< Overflow: new message discarded (DropNewest, bus-wide cap).
+    uint32_t dropped_oldest;       ///< Overflow: oldest queued message discarded (DropOldest).
+    uint32_t block_timeouts;       ///< Overflow: Block publishes that timed out.
+    uint32_t conflated;            ///< Overflow: queued messages replaced (Conflate).
+    uint32_t topics_untracked;     ///< Publishes on topics beyond the stats table.
+};
+
+// ---------------------------------------------------------------------------
+// Tracing (CONFIG_MSGBUS_ENABLE_TRACE)
+// ---------------------------------------------------------------------------
+
+/// Bus event recorded in a TraceRecord.
+enum class TraceEvent : uint8_t {
+    Publish,         ///< Publish() / PublishMany() / Commit() / ISR fan-out entered the bus.
+    Throttle,        ///< Delivery skipped by min_interval_ms.
+    Enqueue,         ///< Async delivery queued for the LVGL task or a worker.
+    Replace,         ///< LvglLatest: queued, replacing a pending message.
+    Drop,            ///< Delivery lost before it was queued (overflow, allocation).
+    Evict,           ///< Queued delivery discarded (DropOldest, Conflate, shed).
+    DispatchBegin,   ///< Callback starts.
+    DispatchEnd,     ///< Callback returned.
+};
+
+/**
+ * @brief One binary trace record, as returned by MessageBus::ReadTrace().
+ *
+ * DumpTrace() writes these unchanged (little-endian, 20 bytes each).
+ */
+struct TraceRecord {
+    uint32_t   time_us;      ///< Low 32 bits of esp_timer_get_time().
+    uint32_t   topic;
+    uint32_t   subscriber;   ///< SubscriptionId; 0 for Publish.
+    uint32_t   task;         ///< Low 32 bits of the recording task's handle.
+    uint16_t   size;         ///< Payload bytes (saturated at 65535).
+    TraceEvent event;
+    uint8_t    core;         ///< CPU that recorded the event.
+};
+static_assert(sizeof(TraceRecord) == 20, "TraceRecord layout is part of the dump format");
+
+/// Encoding used by MessageBus::DumpTrace().
+enum class TraceFormat : uint8_t {
+    Binary,   ///< Raw bytes, for a file.
+    Hex,      ///< "MBTRACE:" hex lines, for the console UART or a log capture.
+};
+
 // ---------------------------------------------------------------------------
 // Bus configuration
 // ---------------------------------------------------------------------------
@@ -80,8 +271,160 @@ static constexpr SubscriptionId kInvalidSubscription = 0;
  * @brief Optional tunables passed to MessageBus::Initialize().
  */
 struct BusConfig {
-    size_t max_subscribers  = 32;   ///< Pre-reserved subscriber slots.
+    size_t max_subscribers  = 32;   ///< Expected subscriber count (sizing hint).
     size_t max_data_size    = 512;  ///< Max payload bytes per Publish().
+    PayloadPoolConfig payload_pool{};  ///< Pool for LvglAsync payload copies.
+    PayloadPoolConfig loan_pool{{0, 0, 0, 0}, {0, 0, 0, 0}};  ///< Pool for LoanBuffer() (heap-backed until configured).
+
+    LvglDispatch lvgl_dispatch   = LvglDispatch::Batched;
+    size_t   lvgl_queue_depth    = 64;  ///< Batched: ring capacity (rounded up to 2^n).
+    size_t   lvgl_batch_size     = 16;  ///< Batched: max deliveries per drain (0 = no limit).
+    uint32_t lvgl_drain_budget_us = 0;  ///< Batched: time budget per drain (0 = no limit).
+    size_t   lvgl_shed_watermark = 0;   ///< Batched: shed Low deliveries once this many are queued (0 = never).
+    size_t   max_inflight        = 0;   ///< Bus-wide cap on queued LvglAsync / Worker deliveries (0 = unlimited).
+
+    size_t   retained_topics     = 0;   ///< Topics that Retain() can mark (0 = disabled).
+    size_t   retained_arena_size = 0;   ///< Bytes shared by all retained values.
+
+    size_t     isr_queue_depth   = 0;     ///< PublishFromISR() ring capacity (0 = disabled, no task).
+    UBaseType_t isr_task_priority = 10;   ///< Priority of the ISR fan-out task.
+    BaseType_t isr_task_core     = tskNO_AFFINITY;  ///< Core affinity of the ISR fan-out task.
+    uint32_t   isr_task_stack    = 4096;  ///< Stack size of the ISR fan-out task (bytes).
+
+    size_t     worker_count       = 0;     ///< DeliveryMode::Worker tasks (0 = Worker disabled).
+    size_t     worker_queue_depth = 16;    ///< Worker queue per subscriber unless max_inflight is set.
+    UBaseType_t worker_task_priority = 5;
+    BaseType_t worker_task_core   = tskNO_AFFINITY;  ///< Core affinity of the worker tasks.
+    uint32_t   worker_task_stack  = 4096;  ///< Stack size of each worker task (bytes).
+};
+
+// ---------------------------------------------------------------------------
+// Subscription options
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Per-subscription settings for MessageBus::Subscribe().
+ */
+struct SubscribeOptions {
+    DeliveryMode     mode             = DeliveryMode::LvglAsync;
+    uint32_t         min_interval_ms  = 0;   ///< Throttle (0 = deliver every message).
+    DeliveryPriority priority         = DeliveryPriority::Normal;
+    uint32_t         max_inflight     = 0;   ///< LvglAsync / Worker: cap on this subscriber's queued deliveries (0 = none / worker_queue_depth).
+    OverflowPolicy   overflow         = OverflowPolicy::DropNewest;  ///< Applied when a cap is reached.
+    uint32_t         block_timeout_ms = 10;  ///< Wait limit for OverflowPolicy::Block.
+    int              worker           = -1;  ///< Worker: pool task to run on (-1 = round robin).
+};
+
+// ---------------------------------------------------------------------------
+// Batch publish
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief One message of MessageBus::PublishMany().
+ */
+struct PublishEntry {
+    uint32_t    topic;
+    const void* data;   ///< Payload (may be nullptr).
+    size_t      size;   ///< Payload size in bytes.
+};
+
+// ---------------------------------------------------------------------------
+// Typed topics
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Compile-time binding of a topic id to its payload type.
+ *
+ * Publishing and subscribing through a descriptor lets the compiler check
+ * the payload: @p T must be trivially copyable and at most
+ * TypedTopic::kMaxSize bytes, and typed callbacks receive a
+ * <tt>const T&</tt> instead of casting Message::data.  A typed publish is
+ * still checked against the configured @c max_data_size and refused (never
+ * truncated) if @c sizeof(T) exceeds it.
+ *
+ * @code
+ * struct SensorReading { float temp; float humidity; };
+ * constexpr msgbus::TypedTopic<SensorReading, 0x0001> kSensor;
+ *
+ * bus.Subscribe(kSensor, [](const SensorReading& r) { ... });
+ * bus.Publish(kSensor, SensorReading{21.5f, 40.0f});
+ * @endcode
+ *
+ * Untyped publishes on the same id whose size differs from @c sizeof(T) are
+ * not delivered to typed callbacks.
+ */
+template <typename T, uint32_t Id>
+struct TypedTopic {
+    using Type = T;
+    static constexpr uint32_t kId      = Id;
+    static constexpr size_t   kMaxSize = 512;   ///< Compile-time ceiling (default BusConfig::max_data_size).
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "TypedTopic payloads are copied bytewise and must be trivially copyable");
+    static_assert(sizeof(T) <= kMaxSize, "TypedTopic payload type too large");
+};
+
+// ---------------------------------------------------------------------------
+// LoanedBuffer
+// ---------------------------------------------------------------------------
+
+class MessageBus;
+
+/**
+ * @brief Bus-owned payload buffer for zero-copy publishing.
+ *
+ * Obtained from MessageBus::LoanBuffer().  The producer writes the payload
+ * straight into Data() and hands it back with MessageBus::Commit(); the bus
+ * delivers that same buffer to every subscriber without copying it.
+ * Destroying an uncommitted buffer returns it to the pool unpublished.
+ * Move-only.
+ */
+class LoanedBuffer {
+public:
+    LoanedBuffer() = default;
+    ~LoanedBuffer();
+
+    LoanedBuffer(LoanedBuffer&& other) noexcept
+        : payload_(other.payload_), data_(other.data_),
+          size_(other.size_), topic_(other.topic_) {
+        other.payload_ = nullptr;
+        other.data_    = nullptr;
+        other.size_    = 0;
+    }
+    LoanedBuffer& operator=(LoanedBuffer&& other) noexcept;
+
+    LoanedBuffer(const LoanedBuffer&) = delete;
+    LoanedBuffer& operator=(const LoanedBuffer&) = delete;
+
+    /** @brief Writable payload area (nullptr if the loan failed). */
+    void* Data() { return data_; }
+
+    /** @brief Payload size in bytes as requested from LoanBuffer(). */
+    size_t Size() const { return size_; }
+
+    /** @brief Topic the buffer will be published on. */
+    uint32_t Topic() const { return topic_; }
+
+    /** @brief Return true if the buffer holds a loan. */
+    bool IsValid() const { return payload_ != nullptr; }
+
+    /** @brief Convenience cast — caller is responsible for size and type safety. */
+    template <typename T>
+    T* As() { return static_cast<T*>(data_); }
+
+    /** @brief Give the buffer back without publishing (idempotent). */
+    void Reset();
+
+private:
+    friend class MessageBus;
+
+    LoanedBuffer(void* payload, void* data, size_t size, uint32_t topic)
+        : payload_(payload), data_(data), size_(size), topic_(topic) {}
+
+    void*    payload_ = nullptr;   ///< MessageBus::AsyncPayload holding one reference.
+    void*    data_    = nullptr;
+    size_t   size_    = 0;
+    uint32_t topic_   = 0;
 };
 
 // ---------------------------------------------------------------------------
@@ -89,24 +432,39 @@ struct BusConfig {
 // ---------------------------------------------------------------------------
 
 /**
- * @brief Singleton publish / subscribe message bus.
+ * @brief Publish / subscribe message bus.
+ *
+ * GetInstance() returns the default bus, which UI code normally uses.
+ * Traffic that must not share a mutex, subscriber table, pools or queues
+ * with it, such as high-rate telemetry on the other core, can use its own
+ * instance: construct a MessageBus, Initialize() it with its own BusConfig
+ * and use it the same way.  Subscription ids are per bus.  A constructed bus
+ * must outlive its subscribers and every delivery still queued for them.
  *
  * Thread safety
  * -------------
  * - Subscribe() / Unsubscribe() / Publish() may be called from **any** thread
- *   or FreeRTOS task (but **not** from ISR).
+ *   or FreeRTOS task (but **not** from ISR).  Publish() never takes the bus
+ *   mutex, so it is not blocked by concurrent Subscribe() bursts.  Interrupt handlers use
+ *   PublishFromISR(), which defers the fan-out to a bus-owned task.
  * - Subscriber callbacks with @c DeliveryMode::Immediate execute in the
  *   publisher's thread; the caller must ensure any shared state is protected.
  * - Subscriber callbacks with @c DeliveryMode::LvglAsync are guaranteed to
- *   execute inside the LVGL task context (via @c lv_async_call()).
+ *   execute inside the LVGL task context (via @c lv_async_call(), see
+ *   LvglDispatch).
  */
 class MessageBus {
 public:
     /**
-     * @brief Access the singleton instance.
+     * @brief Access the default bus.
      */
     static MessageBus& GetInstance();
 
+    MessageBus() = default;
+    ~MessageBus();
+    MessageBus(const MessageBus&) = delete;
+    MessageBus& operator=(const MessageBus&) = delete;
+
     /**
      * @brief One-time initialisation (call before any Subscribe / Publish).
      * @param config  Optional tuning parameters.
@@ -124,19 +482,88 @@ public:
      *                         sooner than the specified interval, effectively
      *                         throttling the subscriber at the bus level.
      *                         Default 0 = deliver every message (no throttle).
+     * @param priority         Drain order of LVGL-thread deliveries
+     *                         (see DeliveryPriority; ignored for Immediate).
      * @return A unique SubscriptionId (never 0), or kInvalidSubscription on error.
      */
     SubscriptionId Subscribe(uint32_t topic, MessageCallback cb,
                              DeliveryMode mode = DeliveryMode::LvglAsync,
-                             uint32_t min_interval_ms = 0);
+                             uint32_t min_interval_ms = 0,
+                             DeliveryPriority priority = DeliveryPriority::Normal);
+
+    /**
+     * @brief Register a callback with the full set of SubscribeOptions
+     *        (in-flight cap and overflow policy).
+     * @return A unique SubscriptionId (never 0), or kInvalidSubscription on error.
+     */
+    SubscriptionId Subscribe(uint32_t topic, MessageCallback cb,
+                             const SubscribeOptions& options);
+
+    /**
+     * @brief Register a callback for every topic in [@p first, @p last].
+     *
+     * Ranges are kept in a pre-built interval index, so a publish finds the
+     * matching ranges with one binary search however many are registered.
+     * Exact-topic subscribers of a message run before range and mask ones.
+     *
+     * @return A unique SubscriptionId, or kInvalidSubscription if
+     *         @p first > @p last or on error.
+     */
+    SubscriptionId SubscribeRange(uint32_t first, uint32_t last, MessageCallback cb,
+                                  const SubscribeOptions& options = {});
+
+    /**
+     * @brief Register a callback for every topic with
+     *        <tt>(topic & mask) == (value & mask)</tt>.
+     *
+     * A mask of contiguous high bits (e.g. 0xFFFFFF00) selects a prefix and
+     * is stored as a range.  Other masks are grouped per distinct mask and
+     * cost one binary search per group on every publish.
+     *
+     * @return A unique SubscriptionId, or kInvalidSubscription on error.
+     */
+    SubscriptionId SubscribeMask(uint32_t value, uint32_t mask, MessageCallback cb,
+                                 const SubscribeOptions& options = {});
+
+    /**
+     * @brief Keep the last message published on @p topic and replay it to
+     *        new subscribers.
+     *
+     * Every later Subscribe() whose topic, range or mask covers @p topic
+     * receives the retained value right away.  Immediate subscribers get it
+     * inside Subscribe().  LVGL-thread subscribers get it from one replay
+     * callback shared by all subscriptions made before the LVGL task next
+     * runs, so a page that subscribes in its constructor renders its first
+     * frame with every retained value.  The replay always carries the newest
+     * value, so it never overwrites a fresher live delivery.
+     *
+     * Values are stored in an arena of @c BusConfig::retained_arena_size
+     * bytes, for up to @c BusConfig::retained_topics topics; publishes
+     * larger than @p max_size are not retained.  Marking a topic is
+     * permanent.  Calling it again for a retained topic is a no-op.
+     *
+     * @return ESP_OK, ESP_ERR_INVALID_STATE before Initialize(), or
+     *         ESP_ERR_NO_MEM if the topic table or arena is full.
+     */
+    esp_err_t Retain(uint32_t topic, size_t max_size);
 
     /**
      * @brief Remove a subscription.
      *
      * Safe to call with @c kInvalidSubscription (no-op).
-     * After this call returns the callback will never be invoked again.
+     * After this call returns the callback will never be invoked again:
+     * LVGL-thread deliveries already queued for it are discarded when they
+     * are drained.  The only exception is a callback that is running at that
+     * moment in another task (an Immediate delivery, or the LVGL task when
+     * unsubscribing from elsewhere); call Unsubscribe() from the task the
+     * callback runs in to rule that out.
+     *
+     * @return ESP_OK (also for @c kInvalidSubscription), ESP_ERR_NOT_FOUND
+     *         for an unknown id, or ESP_ERR_NO_MEM / ESP_ERR_TIMEOUT if the
+     *         new subscriber table could not be built; the subscription is
+     *         then left untouched and the call can be retried.
      */
-    void Unsubscribe(SubscriptionId id);
+    esp_err_t Unsubscribe(SubscriptionId id);
 
     /**
      * @brief Publish a message to all subscribers of @p topic.
@@ -154,46 +581,522 @@ public:
         Publish(topic, &value, sizeof(T));
     }
 
+    /**
+     * @brief Publish a value on a typed topic.
+     *
+     * The payload size is fixed by the type, so it is never truncated: a
+     * type larger than @c BusConfig::max_data_size is logged and not
+     * published.
+     */
+    template <typename T, uint32_t Id>
+    void Publish(TypedTopic<T, Id> /*topic*/, const T& value) {
+        PublishExact(Id, &value, sizeof(T));
+    }
+
+    /**
+     * @brief Subscribe to a typed topic; @p cb is called as
+     *        <tt>cb(const T&)</tt>.
+     */
+    template <typename T, uint32_t Id, typename F>
+    SubscriptionId Subscribe(TypedTopic<T, Id> topic, F&& cb,
+                             DeliveryMode mode = DeliveryMode::LvglAsync) {
+        SubscribeOptions options;
+        options.mode = mode;
+        return Subscribe(topic, std::forward<F>(cb), options);
+    }
+
+    /** @brief Typed Subscribe() with the full set of SubscribeOptions. */
+    template <typename T, uint32_t Id, typename F>
+    SubscriptionId Subscribe(TypedTopic<T, Id> /*topic*/, F&& cb,
+                             const SubscribeOptions& options) {
+        return Subscribe(
+            Id,
+            [fn = std::forward<F>(cb)](const Message& msg) {
+                if (msg.data_size != sizeof(T)) {
+                    return;   // Untyped publish with a different layout.
+                }
+                if (reinterpret_cast<uintptr_t>(msg.data) % alignof(T) == 0) {
+                    fn(*static_cast<const T*>(msg.data));
+                } else {
+                    // Over-aligned types in a pool block: copy out first.
+                    alignas(T) uint8_t copy[sizeof(T)];
+                    memcpy(copy, msg.data, sizeof(T));
+                    fn(*reinterpret_cast<const T*>(copy));
+                }
+            },
+            options);
+    }
+
+    /**
+     * @brief Publish several messages as one frame.
+     *
+     * All entries are matched against the same subscriber snapshot, and the
+     * LvglAsync deliveries of the whole call are handed to the LVGL task as a
+     * single unit: they run back to back in one LVGL callback, in entry
+     * order, so the UI never renders half of the frame.  Immediate
+     * subscribers run in the caller as with Publish(); LvglLatest, Worker
+     * and capped (max_inflight) subscribers use their usual path.
+     *
+     * To stay in one callback the frame bypasses the LvglDispatch::Batched
+     * priority rings: its deliveries ignore DeliveryPriority (Low is never
+     * shed, High gets no precedence), and they are not ordered against the
+     * same subscribers' deliveries from Publish() still in the rings.  If
+     * the frame cannot be handed to LVGL (lv_async_call() fails) it is
+     * dropped and counted in BusStats::alloc_failures.
+     *
+     * @param entries  Messages to publish, in order.
+     * @param count    Number of entries.
+     */
+    void PublishMany(const PublishEntry* entries, size_t count);
+
+    /// Largest payload accepted by PublishFromISR().
+    static constexpr size_t kMaxIsrDataSize = 32;
+
+    /**
+     * @brief Publish a small message from an interrupt handler.
+     *
+     * Copies the payload into a lock-free ring and wakes the bus's ISR
+     * fan-out task, which then delivers it exactly like Publish() (Immediate
+     * subscribers run in that task).  Requires @c BusConfig::isr_queue_depth
+     * > 0.  Not usable while the flash cache is disabled.
+     *
+     * @param topic  Topic identifier.
+     * @param data   Pointer to payload (may be nullptr).
+     * @param size   Payload size, at most kMaxIsrDataSize.
+     * @param woken  Set to pdTRUE if a context switch should be requested
+     *               with portYIELD_FROM_ISR() (may be nullptr).
+     * @return false if the ring is disabled or full, or @p size is too large.
+     */
+    bool PublishFromISR(uint32_t topic, const void* data, size_t size,
+                        BaseType_t* woken);
+
+    /**
+     * @brief Borrow a bus-owned buffer for a zero-copy publish on @p topic.
+     *
+     * The buffer comes from the pool configured by @c BusConfig::loan_pool
+     * and is not limited by @c max_data_size.  Fill it, then Commit() it.
+     *
+     * @return An invalid buffer if the bus is not initialised or the pool
+     *         (and its exhaustion policy) could not provide @p size bytes.
+     */
+    LoanedBuffer LoanBuffer(uint32_t topic, size_t size);
+
+    /**
+     * @brief Publish a loaned buffer to all subscribers of its topic.
+     *
+     * Immediate subscribers read the buffer in place and LVGL-thread
+     * deliveries share it, so the payload is never copied.  The buffer is
+     * returned to the pool after the last delivery.  No-op for an invalid
+     * buffer.
+     */
+    void Commit(LoanedBuffer&& buffer);
+
+    // ---- statistics (CONFIG_MSGBUS_ENABLE_STATS) ----------------------------
+
+    /**
+     * @brief Copy per-topic counters into @p out.
+     * @return Number of entries written (0 when stats are disabled).
+     */
+    size_t GetTopicStats(TopicStats* out, size_t max_entries) const;
+
+    /**
+     * @brief Copy callback timing of the live subscriptions into @p out.
+     * @return Number of entries written (0 when stats are disabled).
+     */
+    size_t GetSubscriberStats(SubscriberStats* out, size_t max_entries);
+
+    /** @brief Bus-wide allocation and overflow counters. */
+    BusStats GetBusStats() const;
+
+    /** @brief Log topic and subscriber tables via ESP_LOGI. */
+    void DumpStats();
+
+    // ---- tracing (CONFIG_MSGBUS_ENABLE_TRACE) -------------------------------
+
+    /**
+     * @brief Pause or resume event recording.
+     *
+     * Recording starts in Initialize().  No-op when tracing is compiled out.
+     */
+    void SetTraceEnabled(bool enabled);
+
+    /**
+     * @brief Copy the trace records written since @p cursor into @p out,
+     *        oldest first, and advance @p cursor past them.
+     *
+     * Start from a cursor of 0 and keep passing the same variable to stream
+     * the trace; records overwritten before they were read are skipped.
+     *
+     * @return Number of records written (0 when tracing is compiled out).
+     */
+    size_t ReadTrace(uint32_t& cursor, TraceRecord* out, size_t max_records) const;
+
+    /**
+     * @brief Write the trace ring to @p out for tools/msgbus_trace.py.
+     *
+     * @c Binary suits a file; @c Hex prints text lines that survive the
+     * console UART (e.g. @c stdout) mixed with log output.  Recording is
+     * paused while the dump runs.
+     *
+     * @return ESP_ERR_NOT_SUPPORTED when tracing is compiled out,
+     *         ESP_ERR_INVALID_STATE before Initialize(), ESP_FAIL if writing
+     *         to @p out failed.
+     */
+    esp_err_t DumpTrace(FILE* out, TraceFormat format = TraceFormat::Binary);
+
     /** @brief Return true if Initialize() has been called successfully. */
     bool IsInitialized() const { return initialized_; }
 
 private:
-    MessageBus() = default;
-    ~MessageBus();
-    MessageBus(const MessageBus&) = delete;
-    MessageBus& operator=(const MessageBus&) = delete;
+    friend class LoanedBuffer;
 
     // --- internal types -----------------------------------------------------
 
-    struct SubscriberEntry {
-        SubscriptionId  id;
-        uint32_t        topic;
-        MessageCallback callback;
-        DeliveryMode    mode;
-        uint32_t        min_interval_ticks;   ///< 0 = deliver every message.
-        uint32_t        last_delivery_tick;    ///< Tick of last delivery.
+    struct AsyncPayload;
+
+    /// How a subscription selects topics.
+    enum class TopicMatch : uint8_t {
+        Exact,
+        Range,
+        Mask,
+    };
+
+#if LVGL_MSG_BUS_STATS
+    /// Lock-free min / avg / max accumulator (microseconds).
+    struct DurationStats {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint32_t> min_us{UINT32_MAX};
+        std::atomic<uint32_t> max_us{0};
+
+        void Add(uint32_t us);
+    };
+
+    /// One row of the open-addressing per-topic counter table.
+    struct TopicCounters {
+        std::atomic<uint32_t> state{0};   ///< 0 = empty, 1 = claiming, 2 = ready.
+        std::atomic<uint32_t> topic{0};
+        std::atomic<uint32_t> publishes{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint32_t> delivered{0};
+        std::atomic<uint32_t> throttled{0};
+        std::atomic<uint32_t> dropped{0};
+        std::atomic<uint32_t> peak_fanout{0};
+    };
+
+    bool           InitStats();
+    TopicCounters* TopicStatsFor(uint32_t topic);
+    bool           ReadTopicRow(size_t index, TopicStats& out) const;
+#endif
+
+#if LVGL_MSG_BUS_TRACE
+    /// Trace ring entry; @c stamp is the record's sequence + 1 once complete.
+    struct TraceSlot {
+        std::atomic<uint32_t> stamp{0};
+        TraceRecord           record;
+    };
+
+    bool InitTrace();
+    void WriteTrace(TraceEvent event, uint32_t topic, SubscriptionId subscriber, size_t size);
+    bool ReadTraceSlot(uint32_t seq, TraceRecord& out) const;
+
+    void Trace(TraceEvent event, uint32_t topic, SubscriptionId subscriber, size_t size) {
+        if (trace_enabled_.load(std::memory_order_relaxed)) {
+            WriteTrace(event, topic, subscriber, size);
+        }
+    }
+#else
+    void Trace(TraceEvent, uint32_t, SubscriptionId, size_t) {}
+#endif
+
+    /**
+     * Heap record for one subscription, allocated once in Subscribe().
+     *
+     * Reference-counted: every SubscriberTable that lists the record holds
+     * one reference and so does every queued delivery, so Publish() never
+     * has to copy the callback.
+     */
+    struct SubscriberRecord {
+        std::atomic<uint32_t> refs{1};
+        MessageBus*           bus;                     ///< Owner, for the static LVGL callbacks.
+        SubscriptionId        id;
+        TopicMatch            match;
+        uint32_t              topic;                   ///< Exact topic, range start or mask value.
+        uint32_t              topic_last;              ///< Range: last topic (inclusive).
+        uint32_t              topic_mask;              ///< Mask: bits compared with @c topic.
+        MessageCallback       callback;
+        std::atomic<bool>     active{true};            ///< Cleared by Unsubscribe(); queued deliveries are skipped.
+        SubscriberRecord*     replay_next = nullptr;   ///< Link in the pending replay list (mutex_).
+        SubscriberRecord*     worker_next = nullptr;   ///< Link in the worker's ready list.
+        uint32_t              worker = 0;              ///< Worker: index into workers_.
+        DeliveryMode          mode;
+        DeliveryPriority      priority;
+        uint32_t              min_interval_ticks;      ///< 0 = deliver every message.
+        std::atomic<uint32_t> last_delivery_tick{0};   ///< Tick of last delivery.
+        std::atomic<AsyncPayload*> pending{nullptr};   ///< LvglLatest: newest undelivered message.
+        uint32_t              max_inflight = 0;        ///< Capacity of @c backlog (0 = no backlog).
+        OverflowPolicy        overflow = OverflowPolicy::DropNewest;
+        uint32_t              block_timeout_ticks = 0;
+        MpscRing<AsyncPayload*> backlog;               ///< Capped LvglAsync: queued messages, oldest first.
+        std::atomic<uint32_t> backlog_count{0};        ///< Reserved @c backlog entries.
+        std::atomic<bool>     wake_armed{false};       ///< A backlog wake-up is queued.
+        std::atomic<uint32_t> dropped{0};              ///< Overflow drops.
+#if LVGL_MSG_BUS_STATS
+        DurationStats         exec;      ///< Callback execution time.
+        DurationStats         latency;   ///< Publish -> callback start (async only).
+#endif
+    };
+
+    /// One topic-index slot; topic and mask are kept inline for a cache-friendly search.
+    struct TableSlot {
+        uint32_t          topic;   ///< Exact topic, range start or masked value.
+        uint32_t          mask;    ///< Mask slots only.
+        SubscriberRecord* record;
+    };
+
+    /**
+     * Elementary interval of the range index: every range subscriber in
+     * Members()[begin, next.begin) covers all topics from @c start up to the
+     * next segment's start.
+     */
+    struct RangeSegment {
+        uint32_t start;
+        uint32_t begin;
     };
 
-    /// Data block queued for lv_async_call().
+    /**
+     * Immutable, reference-counted subscriber index.
+     *
+     * Slots() holds `count` entries in three sections: exact topics sorted by
+     * topic, ranges in subscription order, and masks sorted by (mask, value).
+     * The ranges are also split into `segment_count` disjoint segments sorted
+     * by start (plus an end sentinel), each listing the ranges covering it, so
+     * a publish locates its ranges with a single binary search.
+     *
+     * Subscribe() / Unsubscribe() build a new table and swap it in (RCU-style,
+     * serialised by mutex_); Publish() pins the current one with a reference,
+     * without taking any lock, and iterates it in place.
+     */
+    struct SubscriberTable {
+        std::atomic<uint32_t> refs{1};
+        size_t                count;           ///< All slots; each holds a record reference.
+        size_t                exact_count;
+        size_t                range_count;
+        size_t                segment_count;
+        size_t                member_count;
+        // Followed by `count` TableSlot entries, `member_count` range members
+        // and `segment_count + 1` RangeSegment entries (flexible members).
+        TableSlot* Slots() { return reinterpret_cast<TableSlot*>(this + 1); }
+        SubscriberRecord** Members() {
+            return reinterpret_cast<SubscriberRecord**>(Slots() + count);
+        }
+        RangeSegment* Segments() {
+            return reinterpret_cast<RangeSegment*>(Members() + member_count);
+        }
+    };
+
+    /**
+     * Immutable copy of one published payload, allocated from payload_pool_.
+     *
+     * Shared by every async delivery of that publish: each queued delivery
+     * (and each LvglLatest pending slot) holds one reference, and the block
+     * is freed when the last callback has returned.
+     */
     struct AsyncPayload {
-        MessageCallback callback;
-        uint32_t        topic;
-        uint32_t        timestamp;
-        size_t          data_size;
+        std::atomic<uint32_t> refs{1};
+        MessageBus*           bus;          ///< Owner of the pool the block came from.
+        uint32_t              topic;
+        uint32_t              timestamp;
+        size_t                data_size;
+#if LVGL_MSG_BUS_STATS
+        int64_t               publish_us;   ///< esp_timer_get_time() at publish.
+#endif
         // Followed by `data_size` bytes of payload (flexible member).
         void* DataPtr() { return reinterpret_cast<uint8_t*>(this) + sizeof(AsyncPayload); }
         const void* DataPtr() const { return reinterpret_cast<const uint8_t*>(this) + sizeof(AsyncPayload); }
     };
 
+    /**
+     * One pending async delivery; holds a reference on both @c record and
+     * @c payload.  @c payload == nullptr marks a wake-up: deliver from
+     * @c record->pending (LvglLatest) or @c record->backlog (capped).
+     */
+    struct PendingDelivery {
+        SubscriberRecord* record;
+        AsyncPayload*     payload;
+    };
+
+    /// PublishMany(): deliveries of one frame, in pool-allocated chunks.
+    struct BatchChunk {
+        static constexpr size_t kCapacity = 8;
+
+        MessageBus*     bus;
+        BatchChunk*     next;
+        size_t          count;
+        PendingDelivery items[kCapacity];
+    };
+
+    /// Publisher-side list of the chunks being filled by PublishMany().
+    struct DeliveryBatch {
+        BatchChunk* head = nullptr;
+        BatchChunk* tail = nullptr;
+    };
+
+    /// Stops the tasks and frees everything Initialize() set up.
+    void ReleaseResources();
+
+    void DropBatch(BatchChunk* chunk);
+
+    static SubscriberTable* AllocTable(size_t count, size_t member_count,
+                                       size_t segment_count);
+    static void ReleaseRecord(SubscriberRecord* record);
+    static void ReleaseTable(SubscriberTable* table);
+    static void ReleasePayload(AsyncPayload* payload);
+    static void Deliver(SubscriberRecord* record, const AsyncPayload* payload);
+    void CountDropped(uint32_t topic);
+#if LVGL_MSG_BUS_STATS
+    static void ReadSubscriberStats(const SubscriberRecord* rec, SubscriberStats& out);
+#endif
+    static void ReleaseLoan(void* payload);
+    AsyncPayload* AllocPayload(uint32_t topic, const void* data, size_t size,
+                               uint32_t timestamp);
+    void PublishExact(uint32_t topic, const void* data, size_t size);
+
+    /**
+     * Last value of one Retain()ed topic.  A seqlock like the DataStore flat
+     * slots: @c seq is odd while a publisher rewrites the value, writers are
+     * serialized by @c retained_mutex_, readers copy lock-free and retry.
+     */
+    struct RetainedValue {
+        uint8_t*              data;
+        uint32_t              capacity;
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint32_t> size{0};
+        std::atomic<uint32_t> timestamp{0};
+        std::atomic<bool>     valid{false};
+    };
+
+    static constexpr int kRetainedReadRetries = 4;   ///< Seqlock attempts before locking.
+
+    static bool Matches(const SubscriberRecord* record, uint32_t topic);
+    bool InitRetained();
+    int  FindRetained(uint32_t topic) const;
+    void StoreRetained(uint32_t topic, const void* data, size_t size, uint32_t now);
+    AsyncPayload* SnapshotRetained(size_t index, uint32_t topic);
+    static bool TryCopyRetained(const RetainedValue& value, AsyncPayload* payload, bool& valid);
+    void ReplayRetained(SubscriberRecord* record);
+    bool QueueReplay(SubscriberRecord* record);
+    static void ReplayCb(void* user_data);
+    void Dispatch(uint32_t topic, const void* data, size_t size, uint32_t now,
+                  AsyncPayload* shared);
+    void DispatchTo(SubscriberTable* table, uint32_t topic, const void* data,
+                    size_t size, uint32_t now, AsyncPayload* shared,
+                    DeliveryBatch* batch);
+    bool AppendToBatch(DeliveryBatch& batch, SubscriberRecord* record,
+                       AsyncPayload* payload);
+    SubscriberTable* AcquireTable();
+    SubscriberTable* SwapTable(SubscriberTable* table);
+    static bool BuildTable(SubscriberTable* current, SubscriberRecord* add,
+                           SubscriptionId remove_id, SubscriberTable*& out);
+    SubscriptionId AddSubscriber(TopicMatch match, uint32_t topic, uint32_t arg,
+                                 MessageCallback cb, const SubscribeOptions& options);
+
+    /// Entry of the PublishFromISR() ring (copied by value).
+    struct IsrMessage {
+        uint32_t topic;
+        uint32_t timestamp;
+        uint32_t data_size;
+        uint8_t  data[kMaxIsrDataSize];
+    };
+
+    static void IsrTask(void* arg);
+
+    /// One task of the DeliveryMode::Worker pool.
+    struct Worker {
+        MessageBus*                    bus;
+        TaskHandle_t                   task = nullptr;
+        std::atomic<SubscriberRecord*> ready{nullptr};   ///< Woken records, newest first.
+    };
+
+    esp_err_t   StartWorkers();
+    void        WakeWorker(SubscriberRecord* record);
+    static void WorkerTask(void* arg);
+
     static void LvglAsyncCb(void* user_data);
+    static void LvglWakeCb(void* user_data);
+    static void LvglBatchCb(void* user_data);
+    static void LvglDrainCb(void* user_data);
+    static void LvglDrainTimerCb(lv_timer_t* timer);
+
+    /// One Batched dispatch ring per DeliveryPriority, drained in index order.
+    static constexpr size_t kPriorityCount = 3;
+
+    void   QueueAsync(SubscriberRecord* record, AsyncPayload* payload,
+                      DeliveryBatch* batch);
+    bool   ReserveDelivery(SubscriberRecord* record);
+    bool   TryReserveDelivery(SubscriberRecord* record);
+    bool   EvictBacklog(SubscriberRecord* record);
+    void   ReleaseInflight();
+    void   DropPayload(SubscriberRecord* record, AsyncPayload* payload,
+                       std::atomic<uint32_t>& counter);
+    void   DrainBacklog(SubscriberRecord* record);
+    void   DispatchAsync(SubscriberRecord* record, AsyncPayload* payload);
+    void   FinishDelivery(SubscriberRecord* record, AsyncPayload* payload);
+    void   ShedDelivery(SubscriberRecord* record, AsyncPayload* payload);
+    size_t LvglQueueDepth() const;
+    bool   PopLvglDelivery(PendingDelivery& out);
+    void   DrainLvglQueue();
+    void   ContinueLvglDrain();
 
     // --- data ---------------------------------------------------------------
 
     bool                          initialized_ = false;
     BusConfig                     config_{};
     SemaphoreHandle_t             mutex_ = nullptr;
-    std::vector<SubscriberEntry>  subscribers_;
+    std::atomic<SubscriberTable*> table_{nullptr};    ///< Current snapshot (nullptr = empty).
+    std::atomic<uint32_t>         epoch_{0};          ///< Bumped by every table swap.
+    std::atomic<uint32_t>         readers_[2] = {};   ///< In-flight AcquireTable() per epoch parity.
+    PayloadPool                   payload_pool_;
+    PayloadPool                   loan_pool_;
+    MpscRing<PendingDelivery>     lvgl_queues_[kPriorityCount];  ///< Batched dispatch rings.
+    std::atomic<bool>             drain_scheduled_{false};
+    MpscRing<IsrMessage>          isr_queue_;            ///< PublishFromISR() ring.
+    TaskHandle_t                  isr_task_ = nullptr;
+    Worker*                       workers_ = nullptr;    ///< worker_count entries.
+    uint32_t                      next_worker_ = 0;      ///< Round-robin assignment (mutex_).
+#if LVGL_MSG_BUS_STATS
+    TopicCounters*                topic_stats_ = nullptr;   ///< Power-of-two open-addressing table.
+    size_t                        topic_stats_mask_ = 0;
+    std::atomic<uint32_t>         topics_tracked_{0};
+    std::atomic<uint32_t>         topics_untracked_{0};
+#endif
+#if LVGL_MSG_BUS_TRACE
+    TraceSlot*                    trace_ = nullptr;         ///< Power-of-two ring.
+    uint32_t                      trace_mask_ = 0;
+    std::atomic<uint32_t>         trace_head_{0};           ///< Records ever claimed.
+    std::atomic<bool>             trace_enabled_{false};
+#endif
+    std::atomic<uint32_t>         alloc_failures_{0};
+    std::atomic<uint32_t>         lvgl_shed_{0};
+    std::atomic<uint32_t>         inflight_{0};          ///< Queued LvglAsync deliveries.
+    std::atomic<uint32_t>         inflight_waiters_{0};
+    SemaphoreHandle_t             inflight_freed_ = nullptr;  ///< Signalled for Block waiters.
+    std::atomic<uint32_t>         dropped_newest_{0};
+    std::atomic<uint32_t>         dropped_oldest_{0};
+    std::atomic<uint32_t>         block_timeouts_{0};
+    std::atomic<uint32_t>         conflated_{0};
     SubscriptionId                next_id_ = 1;
+
+    // Retained topics: ids for the publish-side scan, then values, then the
+    // value bytes, all in one block.
+    uint8_t*                      retained_block_ = nullptr;
+    uint32_t*                     retained_ids_   = nullptr;
+    RetainedValue*                retained_       = nullptr;
+    uint8_t*                      retained_arena_ = nullptr;
+    size_t                        retained_used_  = 0;        ///< Arena bytes handed out (mutex_).
+    std::atomic<uint32_t>         retained_count_{0};
+    SemaphoreHandle_t             retained_mutex_ = nullptr;  ///< Serializes StoreRetained() writers.
+    SubscriberRecord*             replay_head_ = nullptr;     ///< Records awaiting ReplayCb (mutex_).
 };
 
 } // namespace msgbus
@@ -0,0 +1,173 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * lvgl-msg-bus — Bounded lock-free multi-producer ring.
+ */
+
+#ifndef LVGL_MSG_BUS_MPSC_RING_H
+#define LVGL_MSG_BUS_MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+
+namespace msgbus {
+
+/**
+ * @brief Bounded lock-free queue for many producers and one consumer.
+ *
+ * Sequence-numbered cell ring (D. Vyukov's bounded queue): producers claim a
+ * cell with one compare-exchange on the tail and publish it by bumping the
+ * cell's sequence number, so pushing never blocks and never allocates.
+ * TryPop() claims the head the same way, so it also tolerates several
+ * consumers (the bus uses that to evict from a subscriber backlog while the
+ * LVGL task drains it).
+ * The capacity is rounded up to a power of two.
+ *
+ * @tparam T  Trivially copyable element type (typically a pointer).
+ */
+template <typename T>
+class MpscRing {
+public:
+    MpscRing() = default;
+    ~MpscRing() { Release(); }
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * @brief Allocate the cell array.
+     * @param capacity  Minimum number of elements (rounded up to 2^n, >= 2).
+     * @param caps      heap_caps for the cell array.
+     */
+    esp_err_t Init(size_t capacity, uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) {
+        Release();
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells_ = static_cast<Cell*>(heap_caps_malloc(size * sizeof(Cell), caps));
+        if (!cells_) {
+            return ESP_ERR_NO_MEM;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            new (&cells_[i]) Cell();
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        mask_ = size - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        return ESP_OK;
+    }
+
+    /** @brief Free the cell array; Init() may be called again.  Not thread-safe. */
+    void Release() {
+        if (cells_) {
+            heap_caps_free(cells_);
+            cells_ = nullptr;
+        }
+        mask_ = 0;
+    }
+
+    /** @brief Return true once Init() succeeded. */
+    bool IsValid() const { return cells_ != nullptr; }
+
+    /** @brief Usable capacity (0 before Init()). */
+    size_t Capacity() const { return cells_ ? mask_ + 1 : 0; }
+
+    /**
+     * @brief Approximate element count (exact when no push/pop is racing).
+     *
+     * Head is read before tail and re-checked afterwards: a stale head would
+     * count entries popped in between, a head newer than the tail could make
+     * the difference wrap.  If pops keep racing, the newest head is used, so
+     * the result may fall short but never exceeds the real count or
+     * Capacity().  The counters wrap on 32-bit targets, hence the signed
+     * difference.
+     */
+    size_t SizeApprox() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        for (int attempt = 0;; ++attempt) {
+            const size_t tail  = tail_.load(std::memory_order_acquire);
+            const size_t again = head_.load(std::memory_order_acquire);
+            if (again == head || attempt == 3) {
+                const intptr_t diff = static_cast<intptr_t>(tail - again);
+                if (diff <= 0) {
+                    return 0;
+                }
+                return static_cast<size_t>(diff) <= mask_ + 1 ? static_cast<size_t>(diff)
+                                                               : mask_ + 1;
+            }
+            head = again;
+        }
+    }
+
+    /**
+     * @brief Enqueue @p value (any thread).
+     * @return false if the ring is full.
+     */
+    bool TryPush(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full.
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Dequeue into @p out.
+     * @return false if the ring is empty.
+     */
+    bool TryPop(T& out) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    out = cell.value;
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty.
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        T                   value{};
+    };
+
+    Cell*               cells_ = nullptr;
+    size_t              mask_  = 0;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
+
+} // namespace msgbus
+
+#endif // LVGL_MSG_BUS_MPSC_RING_H
@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * lvgl-msg-bus — Fixed-block pool for async delivery payloads.
+ */
+
+#ifndef LVGL_MSG_BUS_PAYLOAD_POOL_H
+#define LVGL_MSG_BUS_PAYLOAD_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace msgbus {
+
+// ---------------------------------------------------------------------------
+// Pool configuration
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief What PayloadPool::Alloc() does when no block of a fitting class is free.
+ *
+ * - Drop         : fail the allocation (the delivery is skipped).
+ * - Block        : wait up to @c block_timeout_ms for a block to be freed,
+ *                  then fail.  Never use from the LVGL task — it is the one
+ *                  that frees blocks.
+ * - HeapFallback : allocate from the regular heap instead.
+ */
+enum class PoolExhaustPolicy {
+    Drop,
+    Block,
+    HeapFallback,
+};
+
+/**
+ * @brief Size classes and placement of the async payload pool.
+ *
+ * Each class @c i provides @c block_counts[i] blocks able to hold
+ * @c block_sizes[i] payload bytes.  Classes must be listed in ascending size
+ * order; a class with a zero size or count is unused.  Payloads larger than
+ * the biggest class are handled like an exhausted pool.  Set every count to 0
+ * and keep @c HeapFallback to disable the pool (all payloads then come from
+ * the heap).
+ */
+struct PayloadPoolConfig {
+    static constexpr size_t kMaxClasses = 4;
+
+    size_t   block_sizes[kMaxClasses]  = {32, 128, 512, 0};  ///< Payload bytes per block.
+    size_t   block_counts[kMaxClasses] = {16, 8, 4, 0};      ///< Blocks per class.
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;   ///< heap_caps for the arenas (e.g. MALLOC_CAP_SPIRAM).
+    PoolExhaustPolicy policy = PoolExhaustPolicy::HeapFallback;
+    uint32_t block_timeout_ms = 10;                          ///< Wait limit for PoolExhaustPolicy::Block.
+};
+
+// ---------------------------------------------------------------------------
+// PayloadPool
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Segregated fixed-block allocator.
+ *
+ * Every size class owns one contiguous arena carved into equal blocks and
+ * threaded on an intrusive free list, so Alloc() / Free() are O(1) and never
+ * fragment the heap.  Free() identifies the owning class from the block
+ * address, so blocks carry no extra header.
+ *
+ * Thread safety
+ * -------------
+ * Alloc() and Free() may be called from any task.  The free lists are guarded
+ * by a spinlock, so the pool works across both cores.
+ */
+class PayloadPool {
+public:
+    PayloadPool() = default;
+    ~PayloadPool();
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    /**
+     * @brief Allocate the arenas.
+     * @param config       Size classes, counts, caps and exhaustion policy.
+     * @param header_size  Bytes reserved in every block in front of the
+     *                     payload (the caller's bookkeeping struct).
+     * @return ESP_OK, or ESP_ERR_NO_MEM if an arena could not be allocated.
+     */
+    esp_err_t Init(const PayloadPoolConfig& config, size_t header_size);
+
+    /**
+     * @brief Free the arenas; Init() may be called again.
+     *
+     * Every block must have been returned first.
+     */
+    void Release();
+
+    /**
+     * @brief Allocate a block of at least @p size bytes.
+     * @return nullptr if the pool is exhausted and the policy does not allow
+     *         a fallback (or the heap is exhausted too).
+     */
+    void* Alloc(size_t size);
+
+    /**
+     * @brief Return a block obtained from Alloc() (nullptr is ignored).
+     */
+    void Free(void* block);
+
+    /** @brief Return true if @p block lies in one of this pool's arenas. */
+    bool Owns(const void* block) const { return ClassOf(block) >= 0; }
+
+    /** @brief Number of allocations that fell back to the heap. */
+    uint32_t HeapFallbacks() const { return heap_fallbacks_.load(std::memory_order_relaxed); }
+
+    /** @brief Number of allocations that failed. */
+    uint32_t Failures() const { return failures_.load(std::memory_order_relaxed); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        uint8_t*   arena      = nullptr;
+        size_t     block_size = 0;   ///< Stride, including the header.
+        size_t     count      = 0;
+        FreeBlock* free_list  = nullptr;
+    };
+
+    void* TryAlloc(size_t size);
+    int   ClassOf(const void* block) const;
+
+    PayloadPoolConfig     config_{};
+    SizeClass             classes_[PayloadPoolConfig::kMaxClasses];
+    size_t                class_count_ = 0;
+    portMUX_TYPE          lock_ = portMUX_INITIALIZER_UNLOCKED;
+    SemaphoreHandle_t     freed_ = nullptr;   ///< Signalled on Free() for Block waiters.
+    std::atomic<uint32_t> waiters_{0};
+    std::atomic<uint32_t> heap_fallbacks_{0};
+    std::atomic<uint32_t> failures_{0};
+};
+
+} // namespace msgbus
+
+#endif // LVGL_MSG_BUS_PAYLOAD_POOL_H
@@ -22,7 +22,8 @@ namespace msgbus {
 /**
  * @brief RAII wrapper around a MessageBus subscription.
  *
- * Automatically calls @c MessageBus::Unsubscribe() on destruction.
+ * Automatically calls @c MessageBus::Unsubscribe() on destruction, on the
+ * bus the subscription was made on (the default bus unless one is given).
  * Move-only; cannot be copied.
  *
  * @code
@@ -44,21 +45,31 @@ public:
     /** @brief Default-construct an empty (invalid) subscription. */
     Subscription() = default;
 
-    /** @brief Take ownership of an existing subscription id. */
-    explicit Subscription(SubscriptionId id) : id_(id) {}
+    /**
+     * @brief Take ownership of an existing subscription id on the default bus.
+     *
+     * Ids are per bus: for one from another bus use Subscription(bus, id),
+     * or this guard will unsubscribe from the wrong bus.
+     */
+    explicit Subscription(SubscriptionId id)
+        : Subscription(MessageBus::GetInstance(), id) {}
+
+    /** @brief Take ownership of an existing subscription id on @p bus. */
+    Subscription(MessageBus& bus, SubscriptionId id) : bus_(&bus), id_(id) {}
 
     /** @brief Unsubscribe on destruction. */
     ~Subscription() { Reset(); }
 
     // Move semantics.
-    Subscription(Subscription&& other) noexcept : id_(other.id_) {
+    Subscription(Subscription&& other) noexcept : bus_(other.bus_), id_(other.id_) {
         other.id_ = kInvalidSubscription;
     }
 
     Subscription& operator=(Subscription&& other) noexcept {
         if (this != &other) {
             Reset();
-            id_ = other.id_;
+            bus_ = other.bus_;
+            id_  = other.id_;
             other.id_ = kInvalidSubscription;
         }
         return *this;
@@ -68,22 +79,45 @@ public:
     Subscription(const Subscription&) = delete;
     Subscription& operator=(const Subscription&) = delete;
 
-    /** @brief Unsubscribe immediately (idempotent). */
-    void Reset() {
-        if (id_ != kInvalidSubscription) {
-            MessageBus::GetInstance().Unsubscribe(id_);
+    /**
+     * @brief Unsubscribe immediately (idempotent).
+     *
+     * If the bus cannot build its new subscriber table (ESP_ERR_NO_MEM /
+     * ESP_ERR_TIMEOUT) the id is kept, so a later Reset() retries.
+     */
+    esp_err_t Reset() {
+        if (id_ == kInvalidSubscription) {
+            return ESP_OK;
+        }
+        const esp_err_t err = bus_->Unsubscribe(id_);
+        if (err != ESP_ERR_NO_MEM && err != ESP_ERR_TIMEOUT) {
             id_ = kInvalidSubscription;
         }
+        return err;
     }
 
     /** @brief Return true if currently holding a valid subscription. */
     bool IsValid() const { return id_ != kInvalidSubscription; }
 
+    /**
+     * @brief Give up ownership without unsubscribing.
+     * @return The id, now the caller's to pass to Unsubscribe().
+     */
+    SubscriptionId Release() {
+        const SubscriptionId id = id_;
+        id_ = kInvalidSubscription;
+        return id;
+    }
+
     /** @brief Return the underlying id (for debugging). */
     SubscriptionId Id() const { return id_; }
 
+    /** @brief Bus the subscription belongs to (nullptr if empty). */
+    MessageBus* Bus() const { return IsValid() ? bus_ : nullptr; }
+
 private:
-    SubscriptionId id_ = kInvalidSubscription;
+    MessageBus*    bus_ = nullptr;
+    SubscriptionId id_  = kInvalidSubscription;
 };
 
 // ---------------------------------------------------------------------------
@@ -94,7 +128,8 @@ private:
  * @brief Convenience container that holds multiple Subscription objects.
  *
  * All subscriptions are automatically cancelled when the group is destroyed
- * or when @c Clear() is called.
+ * or when @c Clear() is called.  A group may mix subscriptions of several
+ * buses.
  *
  * @code
  * class MyPage : public PageBase {
@@ -123,10 +158,13 @@ public:
     SubscriptionGroup(const SubscriptionGroup&) = delete;
     SubscriptionGroup& operator=(const SubscriptionGroup&) = delete;
 
-    /** @brief Add a subscription id to the group. */
-    void Add(SubscriptionId id) {
+    /** @brief Add a subscription id of the default bus (see Subscription(id)). */
+    void Add(SubscriptionId id) { Add(MessageBus::GetInstance(), id); }
+
+    /** @brief Add a subscription id of @p bus to the group. */
+    void Add(MessageBus& bus, SubscriptionId id) {
         if (id != kInvalidSubscription) {
-            subs_.emplace_back(id);
+            subs_.emplace_back(bus, id);
         }
     }
 
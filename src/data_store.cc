@@ -6,6 +6,7 @@
 #include "lvgl_msg_bus/data_store.h"
 
 #include <cstring>
+#include <new>
 
 #include <esp_log.h>
 
@@ -14,7 +15,7 @@ static const char* TAG = "DataStore";
 namespace msgbus {
 
 // ---------------------------------------------------------------------------
-// Singleton
+// Default instance
 // ---------------------------------------------------------------------------
 
 DataStore& DataStore::GetInstance() {
@@ -23,6 +24,34 @@ DataStore& DataStore::GetInstance() {
 }
 
 DataStore::~DataStore() {
+    ReleaseResources();
+}
+
+void DataStore::ReleaseResources() {
+    // The persist timer and task first, so no Save() runs while the rest
+    // is freed.
+    if (persist_timer_) {
+        esp_timer_stop(persist_timer_);
+        esp_timer_delete(persist_timer_);
+        persist_timer_ = nullptr;
+    }
+    if (persist_task_) {
+        vTaskDelete(persist_task_);
+        persist_task_ = nullptr;
+    }
+    if (persist_mutex_) {
+        vSemaphoreDelete(persist_mutex_);
+        persist_mutex_ = nullptr;
+    }
+    std::vector<uint32_t>().swap(persist_keys_);
+    persist_armed_.store(false, std::memory_order_relaxed);
+    persist_dirty_.store(false, std::memory_order_relaxed);
+
+    ReleaseFlat();
+    heap_caps_free(scratch_);
+    scratch_ = nullptr;
+    std::vector<uint32_t>().swap(pending_);
+    std::vector<uint32_t>().swap(flushing_);
     if (mutex_) {
         vSemaphoreDelete(mutex_);
         mutex_ = nullptr;
@@ -39,69 +68,528 @@ esp_err_t DataStore::Initialize(const DataStoreConfig& config,
         ESP_LOGW(TAG, "Already initialized");
         return ESP_ERR_INVALID_STATE;
     }
+    if (config.nvs_namespace && config.max_entry_size > kMaxPersistedEntrySize) {
+        ESP_LOGE(TAG, "max_entry_size %u too large to persist (max %u)",
+                 (unsigned)config.max_entry_size, (unsigned)kMaxPersistedEntrySize);
+        return ESP_ERR_INVALID_ARG;
+    }
 
     config_     = config;
     topic_base_ = topic_base;
+    bus_        = config.bus ? config.bus : &MessageBus::GetInstance();
 
+    // Every failure below goes through ReleaseResources(), which undoes the
+    // steps that already ran, so Initialize() can be retried.
     mutex_ = xSemaphoreCreateMutex();
     if (!mutex_) {
         ESP_LOGE(TAG, "Failed to create mutex");
         return ESP_ERR_NO_MEM;
     }
 
+    if (config_.capacity > 0 && InitFlat() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate %u flat slots", (unsigned)config_.capacity);
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (config_.notify == NotifyMode::Coalesced) {
+        // Flat stores know their key count, so the flush never allocates.
+        scratch_ = static_cast<uint8_t*>(heap_caps_malloc(config_.max_entry_size,
+                                                          config_.caps));
+        if (!scratch_) {
+            ESP_LOGE(TAG, "Failed to allocate flush buffer");
+            ReleaseResources();
+            return ESP_ERR_NO_MEM;
+        }
+        pending_.reserve(config_.capacity);
+        flushing_.reserve(config_.capacity);
+        // Let the first change flush without waiting out an interval.
+        last_flush_tick_ = lv_tick_get() - config_.flush_interval_ms;
+    }
+
+    if (config_.nvs_namespace && InitPersistence() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start persistence");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
     initialized_ = true;
-    ESP_LOGI(TAG, "Initialized (max_entry=%u, topic_base=0x%04lx)",
-             (unsigned)config_.max_entry_size, (unsigned long)topic_base_);
+    ESP_LOGI(TAG, "Initialized (max_entry=%u, capacity=%u, topic_base=0x%04lx)",
+             (unsigned)config_.max_entry_size, (unsigned)config_.capacity,
+             (unsigned long)topic_base_);
     return ESP_OK;
 }
 
+// ---------------------------------------------------------------------------
+// Flat storage
+// ---------------------------------------------------------------------------
+
+esp_err_t DataStore::InitFlat() {
+    // Keep the index at most half full so probe sequences stay short.
+    size_t index_size = 2;
+    while (index_size < 2 * config_.capacity) {
+        index_size <<= 1;
+    }
+    slot_stride_ = (sizeof(FlatSlot) + config_.max_entry_size + 3) & ~size_t(3);
+
+    arena_      = static_cast<uint8_t*>(
+        heap_caps_malloc(config_.capacity * slot_stride_, config_.caps));
+    index_      = static_cast<IndexEntry*>(
+        heap_caps_malloc(index_size * sizeof(IndexEntry), config_.caps));
+    free_slots_ = static_cast<uint32_t*>(
+        heap_caps_malloc(config_.capacity * sizeof(uint32_t), config_.caps));
+    if (!arena_ || !index_ || !free_slots_) {
+        ReleaseFlat();
+        return ESP_ERR_NO_MEM;
+    }
+
+    index_mask_ = index_size - 1;
+    for (size_t i = 0; i < index_size; ++i) {
+        new (&index_[i]) IndexEntry();
+        index_[i].key.store(0, std::memory_order_relaxed);
+        index_[i].slot.store(kEmptySlot, std::memory_order_relaxed);
+    }
+    // Hand out low slots first.
+    free_count_ = config_.capacity;
+    for (size_t i = 0; i < free_count_; ++i) {
+        new (SlotAt(static_cast<uint32_t>(i))) FlatSlot();
+        free_slots_[i] = static_cast<uint32_t>(free_count_ - 1 - i);
+    }
+    return ESP_OK;
+}
+
+void DataStore::ReleaseFlat() {
+    heap_caps_free(arena_);
+    heap_caps_free(index_);
+    heap_caps_free(free_slots_);
+    arena_      = nullptr;
+    index_      = nullptr;
+    free_slots_ = nullptr;
+    free_count_ = 0;
+}
+
+DataStore::IndexEntry* DataStore::FindIndex(uint32_t key) const {
+    size_t pos = HomeOf(key);
+    for (size_t probe = 0; probe <= index_mask_; ++probe) {
+        IndexEntry& entry = index_[pos];
+        if (entry.slot.load(std::memory_order_relaxed) == kEmptySlot) {
+            break;
+        }
+        if (entry.key.load(std::memory_order_relaxed) == key) {
+            return &entry;
+        }
+        pos = (pos + 1) & index_mask_;
+    }
+    return nullptr;
+}
+
+void DataStore::BeginIndexWrite() {
+    // Called with mutex_ held.  Readers that overlap see an odd or changed
+    // sequence and retry.
+    index_seq_.store(index_seq_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DataStore::EndIndexWrite() {
+    index_seq_.store(index_seq_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+}
+
+void DataStore::EraseIndex(size_t pos) {
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless that would move them in front of their home position, so
+    // lookups never need tombstones.
+    size_t next = pos;
+    for (;;) {
+        next = (next + 1) & index_mask_;
+        const uint32_t slot = index_[next].slot.load(std::memory_order_relaxed);
+        if (slot == kEmptySlot) {
+            break;
+        }
+        const uint32_t key  = index_[next].key.load(std::memory_order_relaxed);
+        const size_t   home = HomeOf(key);
+        const bool stays = pos <= next ? (pos < home && home <= next)
+                                       : (pos < home || home <= next);
+        if (!stays) {
+            index_[pos].key.store(key, std::memory_order_relaxed);
+            index_[pos].slot.store(slot, std::memory_order_relaxed);
+            pos = next;
+        }
+    }
+    index_[pos].slot.store(kEmptySlot, std::memory_order_relaxed);
+}
+
+void DataStore::WriteSlot(FlatSlot* slot, const void* data, size_t size,
+                          uint32_t version) {
+    const uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(slot->Data(), data, size);
+    slot->size.store(static_cast<uint32_t>(size), std::memory_order_relaxed);
+    slot->version.store(version, std::memory_order_relaxed);
+    slot->seq.store(seq + 2, std::memory_order_release);
+}
+
+bool DataStore::SetFlat(uint32_t key, const void* data, size_t size,
+                        uint32_t version) {
+    // Called with mutex_ held.  Returns true if the stored value changed.
+    if (IndexEntry* entry = FindIndex(key)) {
+        FlatSlot* slot = SlotAt(entry->slot.load(std::memory_order_relaxed));
+        if (slot->size.load(std::memory_order_relaxed) == size &&
+            memcmp(slot->Data(), data, size) == 0) {
+            return false;
+        }
+        WriteSlot(slot, data, size, version);
+        return true;
+    }
+
+    if (free_count_ == 0) {
+        ESP_LOGW(TAG, "Store full (%u keys), key 0x%04lx dropped",
+                 (unsigned)config_.capacity, (unsigned long)key);
+        return false;
+    }
+
+    // New key: fill the slot first, then publish it in the index.  The index
+    // is at most half full, so an empty entry is near.
+    const uint32_t slot_index = free_slots_[--free_count_];
+    WriteSlot(SlotAt(slot_index), data, size, version);
+
+    size_t pos = HomeOf(key);
+    while (index_[pos].slot.load(std::memory_order_relaxed) != kEmptySlot) {
+        pos = (pos + 1) & index_mask_;
+    }
+    BeginIndexWrite();
+    index_[pos].key.store(key, std::memory_order_relaxed);
+    index_[pos].slot.store(slot_index, std::memory_order_relaxed);
+    EndIndexWrite();
+    return true;
+}
+
+DataStore::ReadResult DataStore::TryReadFlat(uint32_t key, void* out, size_t size,
+                                             uint32_t* version,
+                                             size_t* stored_size) const {
+    // Lock-free: validate both the index and the slot sequence after copying.
+    // With @p version, copy only if the slot is newer and report its version;
+    // @p stored_size receives the value size.
+    const uint32_t index_seq = index_seq_.load(std::memory_order_acquire);
+    if (index_seq & 1) {
+        return ReadResult::Retry;
+    }
+
+    const IndexEntry* entry = FindIndex(key);
+    ReadResult result = ReadResult::Missing;
+    uint32_t slot_version = 0;
+    size_t   slot_size    = 0;
+    if (entry) {
+        const uint32_t slot_index = entry->slot.load(std::memory_order_relaxed);
+        if (slot_index >= config_.capacity) {
+            return ReadResult::Retry;   // Entry changed under us.
+        }
+        FlatSlot* slot = SlotAt(slot_index);
+        const uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            return ReadResult::Retry;
+        }
+        // Without @p out only existence is asked for.
+        slot_version = slot->version.load(std::memory_order_relaxed);
+        slot_size    = slot->size.load(std::memory_order_relaxed);
+        if (out && slot_size != size) {
+            result = ReadResult::Missing;
+        } else if (version && slot_version <= *version) {
+            result = ReadResult::Unchanged;
+        } else {
+            result = ReadResult::Ok;
+            if (out) {
+                memcpy(out, slot->Data(), size);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != seq) {
+            return ReadResult::Retry;
+        }
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    if (index_seq_.load(std::memory_order_relaxed) != index_seq) {
+        return ReadResult::Retry;
+    }
+    if (result == ReadResult::Ok && version) {
+        *version = slot_version;
+    }
+    if (result == ReadResult::Ok && stored_size) {
+        *stored_size = slot_size;
+    }
+    return result;
+}
+
+DataStore::ReadResult DataStore::ReadFlat(uint32_t key, void* out, size_t size,
+                                          uint32_t* version,
+                                          size_t* stored_size) const {
+    for (int attempt = 0; attempt < kReadRetries; ++attempt) {
+        const ReadResult result = TryReadFlat(key, out, size, version, stored_size);
+        if (result != ReadResult::Retry) {
+            return result;
+        }
+    }
+
+    // Slow path after repeated overlaps.  Taking the mutex waits for (and
+    // priority-boosts) the writer, so a high-priority reader cannot starve it.
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Get: mutex timeout");
+        return ReadResult::Missing;
+    }
+    const ReadResult result = TryReadFlat(key, out, size, version, stored_size);
+    xSemaphoreGive(mutex_);
+    return result;
+}
+
 // ---------------------------------------------------------------------------
 // SetRaw
 // ---------------------------------------------------------------------------
 
-void DataStore::SetRaw(uint32_t key, const void* data, size_t size) {
-    if (!initialized_ || !data || size == 0) {
-        return;
+bool DataStore::CheckSize(uint32_t key, const void* data, size_t size) const {
+    if (!data || size == 0) {
+        return false;
     }
     if (size > config_.max_entry_size) {
         ESP_LOGW(TAG, "Value too large for key 0x%04lx (%u > %u)",
                  (unsigned long)key, (unsigned)size,
                  (unsigned)config_.max_entry_size);
-        return;
+        return false;
     }
+    return true;
+}
 
+bool DataStore::StoreLocked(uint32_t key, const void* data, size_t size) {
+    // Called with mutex_ held.  Returns true if the stored value changed.
+    const uint32_t version = version_.load(std::memory_order_relaxed) + 1;
     bool changed = false;
+    if (arena_) {
+        changed = SetFlat(key, data, size, version);
+    } else {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            // New entry.
+            Entry entry;
+            entry.data.assign(static_cast<const uint8_t*>(data),
+                              static_cast<const uint8_t*>(data) + size);
+            entry.version = version;
+            entries_.emplace(key, std::move(entry));
+            changed = true;
+        } else {
+            // Existing entry — only update if value differs.
+            auto& existing = it->second.data;
+            if (existing.size() != size ||
+                memcmp(existing.data(), data, size) != 0) {
+                existing.assign(static_cast<const uint8_t*>(data),
+                                static_cast<const uint8_t*>(data) + size);
+                it->second.version = version;
+                changed = true;
+            }
+        }
+    }
+
+    if (changed) {
+        version_.store(version, std::memory_order_release);
+    }
+    return changed;
+}
+
+bool DataStore::ApplyLocked(uint32_t key, const void* data, size_t size) {
+    // StoreLocked() plus the bookkeeping of a changed value.
+    const bool changed = StoreLocked(key, data, size);
+    if (changed && IsPersisted(key)) {
+        persist_dirty_.store(true, std::memory_order_relaxed);
+    }
+    if (changed && config_.notify == NotifyMode::Coalesced) {
+        bool* dirty = DirtyFlag(key);
+        if (dirty && !*dirty) {
+            *dirty = true;
+            pending_.push_back(key);
+        }
+    }
+    return changed;
+}
+
+void DataStore::SetRaw(uint32_t key, const void* data, size_t size) {
+    if (!initialized_ || !CheckSize(key, data, size)) {
+        return;
+    }
 
     if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Set: mutex timeout");
         return;
     }
+    const bool changed = ApplyLocked(key, data, size);
+    xSemaphoreGive(mutex_);
 
+    // Publish change notification outside the lock.
+    if (!changed) {
+        return;
+    }
+    SchedulePersist();
+    if (config_.notify == NotifyMode::Immediate) {
+        bus_->Publish(topic_base_ + key, data, size);
+    } else if (!flush_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        lv_async_call(FlushCb, this);
+    }
+}
+
+bool DataStore::PeekLocked(uint32_t key, const uint8_t*& data, size_t& size) const {
+    // Called with mutex_ held; @p data stays valid until it is released.
+    if (arena_) {
+        IndexEntry* entry = FindIndex(key);
+        if (!entry) {
+            return false;
+        }
+        FlatSlot* slot = SlotAt(entry->slot.load(std::memory_order_relaxed));
+        data = slot->Data();
+        size = slot->size.load(std::memory_order_relaxed);
+        return true;
+    }
     auto it = entries_.find(key);
     if (it == entries_.end()) {
-        // New entry.
-        Entry entry;
-        entry.data.assign(static_cast<const uint8_t*>(data),
-                          static_cast<const uint8_t*>(data) + size);
-        entries_.emplace(key, std::move(entry));
-        changed = true;
-    } else {
-        // Existing entry — only update if value differs.
-        auto& existing = it->second.data;
-        if (existing.size() != size ||
-            memcmp(existing.data(), data, size) != 0) {
-            existing.assign(static_cast<const uint8_t*>(data),
-                            static_cast<const uint8_t*>(data) + size);
-            changed = true;
+        return false;
+    }
+    data = it->second.data.data();
+    size = it->second.data.size();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// SetMany
+// ---------------------------------------------------------------------------
+
+void DataStore::SetMany(const StoreWrite* writes, size_t count) {
+    if (!initialized_ || !writes || count == 0) {
+        return;
+    }
+
+    // Notifications of the changed keys, built under the lock and published
+    // after it.  Small updates stay on the stack.
+    static constexpr size_t kLocalEntries = 8;
+    PublishEntry  local[kLocalEntries];
+    PublishEntry* changes = local;
+    const bool immediate = config_.notify == NotifyMode::Immediate;
+    if (immediate && count > kLocalEntries) {
+        changes = new (std::nothrow) PublishEntry[count];
+        if (!changes) {
+            ESP_LOGE(TAG, "SetMany: out of memory");
+            return;
         }
     }
 
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "SetMany: mutex timeout");
+        if (changes != local) {
+            delete[] changes;
+        }
+        return;
+    }
+    size_t changed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const StoreWrite& w = writes[i];
+        if (CheckSize(w.key, w.data, w.size) && ApplyLocked(w.key, w.data, w.size)) {
+            if (immediate) {
+                changes[changed] = PublishEntry{topic_base_ + w.key, w.data, w.size};
+            }
+            ++changed;
+        }
+    }
     xSemaphoreGive(mutex_);
 
-    // Publish change notification outside the lock.
-    if (changed) {
-        MessageBus::GetInstance().Publish(topic_base_ + key, data, size);
+    if (changed > 0) {
+        SchedulePersist();
+    }
+    if (immediate) {
+        bus_->PublishMany(changes, changed);
+    } else if (changed > 0 && !flush_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        lv_async_call(FlushCb, this);
+    }
+    if (changes != local) {
+        delete[] changes;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Coalesced notifications (flush runs in the LVGL task)
+// ---------------------------------------------------------------------------
+
+bool* DataStore::DirtyFlag(uint32_t key) {
+    // Called with mutex_ held.
+    if (arena_) {
+        IndexEntry* entry = FindIndex(key);
+        return entry ? &SlotAt(entry->slot.load(std::memory_order_relaxed))->dirty : nullptr;
+    }
+    auto it = entries_.find(key);
+    return it != entries_.end() ? &it->second.dirty : nullptr;
+}
+
+bool DataStore::TakeDirty(uint32_t key, size_t& size) {
+    // Copy the latest value of a still-dirty key into scratch_.  Keys removed
+    // (or queued twice) since they were marked are skipped.
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Flush: mutex timeout");
+        return false;
+    }
+    bool* dirty = DirtyFlag(key);
+    const uint8_t* data = nullptr;
+    const bool take = dirty && *dirty && PeekLocked(key, data, size);
+    if (take) {
+        *dirty = false;
+        memcpy(scratch_, data, size);
+    }
+    xSemaphoreGive(mutex_);
+    return take;
+}
+
+void DataStore::Flush() {
+    last_flush_tick_ = lv_tick_get();
+
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Flush: mutex timeout");
+        flush_scheduled_.store(false, std::memory_order_release);
+        return;
+    }
+    pending_.swap(flushing_);
+    // A Set() after this point queues the next flush.
+    flush_scheduled_.store(false, std::memory_order_release);
+    xSemaphoreGive(mutex_);
+
+    MessageBus& bus = *bus_;
+    size_t notified = 0;
+    for (uint32_t key : flushing_) {
+        size_t size = 0;
+        if (TakeDirty(key, size)) {
+            bus.Publish(topic_base_ + key, scratch_, size);
+            flushing_[notified++] = key;
+        }
     }
+    if (notified > 0) {
+        const ChangeSet changes{flushing_.data(), notified};
+        bus.Publish(ChangeSetTopic(), changes);
+    }
+    flushing_.clear();
+}
+
+void DataStore::FlushCb(void* user_data) {
+    auto* store = static_cast<DataStore*>(user_data);
+    const uint32_t interval = store->config_.flush_interval_ms;
+    const uint32_t elapsed  = lv_tick_get() - store->last_flush_tick_;
+    if (interval > 0 && elapsed < interval) {
+        // Too soon after the last flush: run once the interval is over.
+        lv_timer_t* timer = lv_timer_create(FlushTimerCb, interval - elapsed, store);
+        if (timer) {
+            lv_timer_set_repeat_count(timer, 1);
+            return;
+        }
+    }
+    store->Flush();
+}
+
+void DataStore::FlushTimerCb(lv_timer_t* timer) {
+    static_cast<DataStore*>(lv_timer_get_user_data(timer))->Flush();
 }
 
 // ---------------------------------------------------------------------------
@@ -113,6 +601,10 @@ bool DataStore::GetRaw(uint32_t key, void* out, size_t size) const {
         return false;
     }
 
+    if (arena_) {
+        return ReadFlat(key, out, size) == ReadResult::Ok;
+    }
+
     if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Get: mutex timeout");
         return false;
@@ -129,27 +621,163 @@ bool DataStore::GetRaw(uint32_t key, void* out, size_t size) const {
     return ok;
 }
 
+bool DataStore::GetRawIfNewer(uint32_t key, uint32_t& version, void* out,
+                              size_t size) const {
+    if (!initialized_ || !out || size == 0) {
+        return false;
+    }
+    // No key can be newer than the store itself.
+    if (version_.load(std::memory_order_acquire) <= version) {
+        return false;
+    }
+
+    if (arena_) {
+        return ReadFlat(key, out, size, &version) == ReadResult::Ok;
+    }
+
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Get: mutex timeout");
+        return false;
+    }
+
+    bool ok = false;
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.data.size() == size &&
+        it->second.version > version) {
+        memcpy(out, it->second.data.data(), size);
+        version = it->second.version;
+        ok = true;
+    }
+
+    xSemaphoreGive(mutex_);
+    return ok;
+}
+
+uint32_t DataStore::GetVersion(uint32_t key) const {
+    if (!initialized_) {
+        return 0;
+    }
+
+    uint32_t version = 0;
+    if (arena_) {
+        ReadFlat(key, nullptr, 0, &version);
+        return version;
+    }
+
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Get: mutex timeout");
+        return 0;
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        version = it->second.version;
+    }
+    xSemaphoreGive(mutex_);
+    return version;
+}
+
+size_t DataStore::GetSize(uint32_t key) const {
+    if (!initialized_) {
+        return 0;
+    }
+
+    size_t size = 0;
+    if (arena_) {
+        ReadFlat(key, nullptr, 0, nullptr, &size);
+        return size;
+    }
+
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Get: mutex timeout");
+        return 0;
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        size = it->second.data.size();
+    }
+    xSemaphoreGive(mutex_);
+    return size;
+}
+
+DataStore::View DataStore::GetView(uint32_t key) const {
+    if (!initialized_) {
+        return View();
+    }
+
+    // Writers hold mutex_ too, so the value cannot change under the view.
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "GetView: mutex timeout");
+        return View();
+    }
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!PeekLocked(key, data, size)) {
+        xSemaphoreGive(mutex_);
+        return View();
+    }
+    return View(mutex_, data, size);
+}
+
 // ---------------------------------------------------------------------------
 // Watch / Unwatch
 // ---------------------------------------------------------------------------
 
-SubscriptionId DataStore::Watch(uint32_t key,
-                                std::function<void(uint32_t key)> callback) {
+// The returned guards carry bus_, so a store bound to DataStoreConfig::bus
+// never unwatches on the default bus.
+
+Subscription DataStore::Watch(uint32_t key,
+                              std::function<void(uint32_t key)> callback) {
     if (!initialized_ || !callback) {
-        return kInvalidSubscription;
+        return Subscription();
     }
 
     const uint32_t topic = topic_base_ + key;
 
     // Wrap the user callback so it receives just the key.
-    return MessageBus::GetInstance().Subscribe(
+    return Subscription(*bus_, bus_->Subscribe(
         topic,
         [key, cb = std::move(callback)](const Message& /*msg*/) { cb(key); },
-        DeliveryMode::LvglAsync);
+        WatchMode()));
 }
 
-void DataStore::Unwatch(SubscriptionId id) {
-    MessageBus::GetInstance().Unsubscribe(id);
+Subscription DataStore::WatchRange(uint32_t first_key, uint32_t last_key,
+                                   std::function<void(uint32_t key)> callback) {
+    if (!initialized_ || !callback) {
+        return Subscription();
+    }
+
+    const uint32_t base = topic_base_;
+    SubscribeOptions options;
+    options.mode = WatchMode();
+    return Subscription(*bus_, bus_->SubscribeRange(
+        base + first_key, base + last_key,
+        [base, cb = std::move(callback)](const Message& msg) { cb(msg.topic - base); },
+        options));
+}
+
+Subscription DataStore::WatchChanges(
+    std::function<void(const uint32_t* keys, size_t count)> callback) {
+    if (!initialized_ || !callback) {
+        return Subscription();
+    }
+    if (config_.notify != NotifyMode::Coalesced) {
+        ESP_LOGW(TAG, "WatchChanges needs NotifyMode::Coalesced");
+        return Subscription();
+    }
+
+    // The flush publishes from the LVGL task, so deliver in place: the key
+    // array is only valid during the publish.
+    return Subscription(*bus_, bus_->Subscribe(
+        ChangeSetTopic(),
+        [cb = std::move(callback)](const Message& msg) {
+            const ChangeSet& changes = msg.As<ChangeSet>();
+            cb(changes.keys, changes.count);
+        },
+        DeliveryMode::Immediate));
+}
+
+esp_err_t DataStore::Unwatch(SubscriptionId id) {
+    return bus_->Unsubscribe(id);
 }
 
 // ---------------------------------------------------------------------------
@@ -161,6 +789,10 @@ bool DataStore::Contains(uint32_t key) const {
         return false;
     }
 
+    if (arena_) {
+        return ReadFlat(key, nullptr, 0) == ReadResult::Ok;
+    }
+
     if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
         return false;
     }
@@ -181,9 +813,30 @@ void DataStore::Remove(uint32_t key) {
         return;
     }
 
-    entries_.erase(key);
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (IsPersisted(key) && PeekLocked(key, data, size)) {
+        persist_dirty_.store(true, std::memory_order_relaxed);
+    }
+    bool removed = false;
+    if (!arena_) {
+        removed = entries_.erase(key) > 0;
+    } else if (IndexEntry* entry = FindIndex(key)) {
+        const uint32_t slot = entry->slot.load(std::memory_order_relaxed);
+        SlotAt(slot)->dirty = false;   // A pending flush skips the key.
+        free_slots_[free_count_++] = slot;
+        BeginIndexWrite();
+        EraseIndex(static_cast<size_t>(entry - index_));
+        EndIndexWrite();
+        removed = true;
+    }
+    if (removed) {
+        version_.store(version_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+    }
 
     xSemaphoreGive(mutex_);
+    SchedulePersist();
 }
 
 } // namespace msgbus
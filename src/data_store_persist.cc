@@ -0,0 +1,238 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * DataStore persistence: debounced NVS snapshots of selected keys.
+ */
+
+#include "lvgl_msg_bus/data_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <nvs.h>
+
+static const char* TAG = "DataStore";
+
+namespace msgbus {
+
+namespace {
+
+// The snapshot is one NVS blob: a header, then for every stored key
+// {uint32_t key, uint16_t size, size value bytes}, unaligned.  Initialize()
+// caps max_entry_size at kMaxPersistedEntrySize so every size fits.
+constexpr char     kBlobName[]    = "snapshot";
+constexpr uint32_t kBlobMagic     = 0x5344424D;   // "MBDS"
+constexpr uint16_t kBlobVersion   = 1;
+constexpr size_t   kRecordHeader  = sizeof(uint32_t) + sizeof(uint16_t);
+
+struct BlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;    ///< Records that follow.
+    uint32_t length;   ///< Bytes of records.
+    uint32_t crc;      ///< esp_rom_crc32_le() of the records.
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Setup / restore (Initialize)
+// ---------------------------------------------------------------------------
+
+esp_err_t DataStore::InitPersistence() {
+    persist_keys_.assign(config_.persist_keys,
+                         config_.persist_keys + (config_.persist_keys ? config_.persist_key_count : 0));
+    std::sort(persist_keys_.begin(), persist_keys_.end());
+    persist_keys_.erase(std::unique(persist_keys_.begin(), persist_keys_.end()),
+                        persist_keys_.end());
+
+    // On failure Initialize() releases whatever was created here.
+    persist_mutex_ = xSemaphoreCreateMutex();
+    if (!persist_mutex_) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback        = PersistTimerCb;
+    args.arg             = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "ds_persist";
+    if (esp_timer_create(&args, &persist_timer_) != ESP_OK) {
+        persist_timer_ = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreatePinnedToCore(PersistTask, "ds_persist", config_.persist_task_stack,
+                                this, config_.persist_task_priority, &persist_task_,
+                                config_.persist_task_core) != pdPASS) {
+        persist_task_ = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+
+    Restore();
+    return ESP_OK;
+}
+
+bool DataStore::IsPersisted(uint32_t key) const {
+    return !persist_keys_.empty() &&
+           std::binary_search(persist_keys_.begin(), persist_keys_.end(), key);
+}
+
+void DataStore::Restore() {
+    // One blob read; nobody can watch the keys yet, so nothing is notified.
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(config_.nvs_namespace, NVS_READONLY, &nvs);
+    std::vector<uint8_t> blob;
+    if (err == ESP_OK) {
+        size_t length = 0;
+        err = nvs_get_blob(nvs, kBlobName, nullptr, &length);
+        if (err == ESP_OK) {
+            blob.resize(length);
+            err = nvs_get_blob(nvs, kBlobName, blob.data(), &length);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Snapshot read failed (0x%x)", err);
+        }
+        return;
+    }
+
+    BlobHeader header;
+    if (blob.size() < sizeof(header)) {
+        ESP_LOGW(TAG, "Snapshot truncated, ignored");
+        return;
+    }
+    memcpy(&header, blob.data(), sizeof(header));
+    const uint8_t* p   = blob.data() + sizeof(header);
+    const uint8_t* end = blob.data() + blob.size();
+    if (header.magic != kBlobMagic || header.version != kBlobVersion ||
+        header.length != static_cast<size_t>(end - p) ||
+        esp_rom_crc32_le(0, p, header.length) != header.crc) {
+        ESP_LOGW(TAG, "Snapshot invalid (bad header or CRC), ignored");
+        return;
+    }
+
+    size_t restored = 0;
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Restore: mutex timeout");
+        return;
+    }
+    for (uint16_t i = 0; i < header.count && static_cast<size_t>(end - p) >= kRecordHeader; ++i) {
+        uint32_t key;
+        uint16_t size;
+        memcpy(&key, p, sizeof(key));
+        memcpy(&size, p + sizeof(key), sizeof(size));
+        p += kRecordHeader;
+        if (size > end - p) {
+            break;
+        }
+        // Keys dropped from persist_keys or grown past max_entry_size are skipped.
+        if (IsPersisted(key) && size > 0 && size <= config_.max_entry_size &&
+            StoreLocked(key, p, size)) {
+            ++restored;
+        }
+        p += size;
+    }
+    xSemaphoreGive(mutex_);
+
+    ESP_LOGI(TAG, "Restored %u of %u keys from NVS", (unsigned)restored,
+             (unsigned)header.count);
+}
+
+// ---------------------------------------------------------------------------
+// Save (debounced)
+// ---------------------------------------------------------------------------
+
+void DataStore::SchedulePersist() {
+    // The timer starts at the first unsaved change and is not pushed back by
+    // later ones, so a value that keeps changing is still saved regularly.
+    if (persist_timer_ && persist_dirty_.load(std::memory_order_relaxed) &&
+        !persist_armed_.exchange(true, std::memory_order_acq_rel)) {
+        esp_timer_start_once(persist_timer_,
+                             static_cast<uint64_t>(config_.persist_delay_ms) * 1000);
+    }
+}
+
+void DataStore::PersistTimerCb(void* arg) {
+    // Runs in the esp_timer task, which also drives the LVGL tick: only hand
+    // off.  Save() waits on mutexes and NVS erases flash.
+    auto* store = static_cast<DataStore*>(arg);
+    store->persist_armed_.store(false, std::memory_order_release);
+    xTaskNotifyGive(store->persist_task_);
+}
+
+void DataStore::PersistTask(void* arg) {
+    auto* store = static_cast<DataStore*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        store->Save();
+    }
+}
+
+esp_err_t DataStore::Save() {
+    if (!initialized_ || !persist_timer_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Serialise whole saves so an older snapshot never overwrites a newer one.
+    if (xSemaphoreTake(persist_mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Save: mutex timeout");
+        return ESP_ERR_TIMEOUT;
+    }
+    if (!persist_dirty_.exchange(false, std::memory_order_acq_rel)) {
+        xSemaphoreGive(persist_mutex_);
+        return ESP_OK;
+    }
+
+    std::vector<uint8_t> blob(sizeof(BlobHeader));
+    BlobHeader header = {kBlobMagic, kBlobVersion, 0, 0, 0};
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        persist_dirty_.store(true, std::memory_order_relaxed);
+        xSemaphoreGive(persist_mutex_);
+        ESP_LOGE(TAG, "Save: mutex timeout");
+        return ESP_ERR_TIMEOUT;
+    }
+    for (uint32_t key : persist_keys_) {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        if (!PeekLocked(key, data, size)) {
+            continue;
+        }
+        const uint16_t size16 = static_cast<uint16_t>(size);
+        const size_t at = blob.size();
+        blob.resize(at + kRecordHeader + size);
+        memcpy(&blob[at], &key, sizeof(key));
+        memcpy(&blob[at + sizeof(key)], &size16, sizeof(size16));
+        memcpy(&blob[at + kRecordHeader], data, size);
+        ++header.count;
+    }
+    xSemaphoreGive(mutex_);
+
+    header.length = static_cast<uint32_t>(blob.size() - sizeof(header));
+    header.crc    = esp_rom_crc32_le(0, blob.data() + sizeof(header), header.length);
+    memcpy(blob.data(), &header, sizeof(header));
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(config_.nvs_namespace, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, kBlobName, blob.data(), blob.size());
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        persist_dirty_.store(true, std::memory_order_relaxed);   // Retry on the next change.
+        ESP_LOGE(TAG, "Snapshot write failed (0x%x)", err);
+    } else {
+        ESP_LOGD(TAG, "Saved %u keys (%u bytes)", (unsigned)header.count,
+                 (unsigned)blob.size());
+    }
+    xSemaphoreGive(persist_mutex_);
+    return err;
+}
+
+} // namespace msgbus
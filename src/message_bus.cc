@@ -5,10 +5,14 @@
 
 #include "lvgl_msg_bus/message_bus.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 
+#include <esp_heap_caps.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <lvgl.h>
@@ -18,7 +22,38 @@ static const char* TAG = "MsgBus";
 namespace msgbus {
 
 // ---------------------------------------------------------------------------
-// Singleton
+// LoanedBuffer
+// ---------------------------------------------------------------------------
+
+LoanedBuffer::~LoanedBuffer() {
+    Reset();
+}
+
+LoanedBuffer& LoanedBuffer::operator=(LoanedBuffer&& other) noexcept {
+    if (this != &other) {
+        Reset();
+        payload_ = other.payload_;
+        data_    = other.data_;
+        size_    = other.size_;
+        topic_   = other.topic_;
+        other.payload_ = nullptr;
+        other.data_    = nullptr;
+        other.size_    = 0;
+    }
+    return *this;
+}
+
+void LoanedBuffer::Reset() {
+    if (payload_) {
+        MessageBus::ReleaseLoan(payload_);
+        payload_ = nullptr;
+        data_    = nullptr;
+        size_    = 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Default instance
 // ---------------------------------------------------------------------------
 
 MessageBus& MessageBus::GetInstance() {
@@ -27,10 +62,337 @@ MessageBus& MessageBus::GetInstance() {
 }
 
 MessageBus::~MessageBus() {
+    ReleaseResources();
+    heap_caps_free(retained_block_);
+    retained_block_ = nullptr;
+    if (retained_mutex_) {
+        vSemaphoreDelete(retained_mutex_);
+        retained_mutex_ = nullptr;
+    }
+}
+
+void MessageBus::ReleaseResources() {
+    // Tasks first, so nothing touches the rings, pools or table being freed.
+    if (isr_task_) {
+        vTaskDelete(isr_task_);
+        isr_task_ = nullptr;
+    }
+    if (workers_) {
+        for (size_t i = 0; i < config_.worker_count; ++i) {
+            if (workers_[i].task) {
+                vTaskDelete(workers_[i].task);
+            }
+        }
+        delete[] workers_;
+        workers_ = nullptr;
+    }
+#if LVGL_MSG_BUS_TRACE
+    trace_enabled_.store(false, std::memory_order_relaxed);
+    delete[] trace_;
+    trace_ = nullptr;
+#endif
+#if LVGL_MSG_BUS_STATS
+    delete[] topic_stats_;
+    topic_stats_ = nullptr;
+#endif
+    if (SubscriberTable* table = table_.exchange(nullptr)) {
+        ReleaseTable(table);
+    }
+    isr_queue_.Release();
+    for (auto& queue : lvgl_queues_) {
+        queue.Release();
+    }
+    loan_pool_.Release();
+    payload_pool_.Release();
     if (mutex_) {
         vSemaphoreDelete(mutex_);
         mutex_ = nullptr;
     }
+    if (inflight_freed_) {
+        vSemaphoreDelete(inflight_freed_);
+        inflight_freed_ = nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Subscriber records / tables / payloads (reference counted)
+// ---------------------------------------------------------------------------
+
+MessageBus::SubscriberTable* MessageBus::AllocTable(size_t count, size_t member_count,
+                                                   size_t segment_count) {
+    void* mem = malloc(sizeof(SubscriberTable) + count * sizeof(TableSlot) +
+                       member_count * sizeof(SubscriberRecord*) +
+                       (segment_count + 1) * sizeof(RangeSegment));
+    if (!mem) {
+        return nullptr;
+    }
+    auto* table          = new (mem) SubscriberTable();
+    table->count         = count;
+    table->member_count  = member_count;
+    table->segment_count = segment_count;
+    return table;
+}
+
+void MessageBus::ReleaseRecord(SubscriberRecord* record) {
+    if (record->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete record;
+    }
+}
+
+void MessageBus::ReleaseTable(SubscriberTable* table) {
+    if (table->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    TableSlot* slots = table->Slots();
+    for (size_t i = 0; i < table->count; ++i) {
+        ReleaseRecord(slots[i].record);
+    }
+    table->~SubscriberTable();
+    free(table);
+}
+
+MessageBus::AsyncPayload* MessageBus::AllocPayload(uint32_t topic, const void* data,
+                                                   size_t size, uint32_t timestamp) {
+    const size_t alloc_size = sizeof(AsyncPayload) + size;
+    void* mem = payload_pool_.Alloc(alloc_size);
+    if (!mem) {
+        alloc_failures_.fetch_add(1, std::memory_order_relaxed);
+        ESP_LOGE(TAG, "Async alloc failed (%u bytes)", (unsigned)alloc_size);
+        return nullptr;
+    }
+
+    auto* payload      = new (mem) AsyncPayload();
+    payload->bus       = this;
+    payload->topic     = topic;
+    payload->timestamp = timestamp;
+    payload->data_size = size;
+#if LVGL_MSG_BUS_STATS
+    payload->publish_us = esp_timer_get_time();
+#endif
+    if (size > 0 && data) {
+        memcpy(payload->DataPtr(), data, size);
+    }
+    return payload;
+}
+
+void MessageBus::ReleasePayload(AsyncPayload* payload) {
+    if (payload->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        MessageBus* bus = payload->bus;
+        payload->~AsyncPayload();
+        if (bus->loan_pool_.Owns(payload)) {
+            bus->loan_pool_.Free(payload);
+        } else {
+            bus->payload_pool_.Free(payload);
+        }
+    }
+}
+
+MessageBus::SubscriberTable* MessageBus::AcquireTable() {
+    // Lock-free read side.  Register in the current epoch's reader count,
+    // confirm the epoch did not move meanwhile, then pin the table with a
+    // reference.  The section is a handful of atomics, so writers waiting in
+    // SwapTable() are released almost immediately.
+    uint32_t epoch;
+    for (;;) {
+        epoch = epoch_.load();
+        readers_[epoch & 1].fetch_add(1);
+        if (epoch_.load() == epoch) {
+            break;
+        }
+        readers_[epoch & 1].fetch_sub(1);
+    }
+
+    SubscriberTable* table = table_.load();
+    if (table) {
+        table->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    readers_[epoch & 1].fetch_sub(1, std::memory_order_release);
+    return table;
+}
+
+MessageBus::SubscriberTable* MessageBus::SwapTable(SubscriberTable* table) {
+    // Called with mutex_ held.  Publish the new table, then flip the epoch and
+    // wait until every reader that could still be about to reference the old
+    // table has pinned it (deferred reclamation).
+    SubscriberTable* old = table_.exchange(table);
+    const uint32_t epoch = epoch_.fetch_add(1);
+    for (uint32_t spins = 0; readers_[epoch & 1].load() != 0; ++spins) {
+        if (spins > 16) {
+            vTaskDelay(1);  // Let a preempted lower-priority reader finish.
+        }
+    }
+    return old;
+}
+
+bool MessageBus::BuildTable(SubscriberTable* current, SubscriberRecord* add,
+                            SubscriptionId remove_id, SubscriberTable*& out) {
+    TableSlot* const src = current ? current->Slots() : nullptr;
+    const size_t old_count  = current ? current->count : 0;
+    const size_t old_exact  = current ? current->exact_count : 0;
+    const size_t old_ranges = old_exact + (current ? current->range_count : 0);
+
+    // Section sizes of the new table.
+    size_t removed = old_count;
+    size_t exact   = old_exact;
+    size_t ranges  = old_ranges - old_exact;
+    for (size_t i = 0; remove_id != kInvalidSubscription && i < old_count; ++i) {
+        if (src[i].record->id == remove_id) {
+            removed = i;
+            if (i < old_exact) {
+                --exact;
+            } else if (i < old_ranges) {
+                --ranges;
+            }
+            break;
+        }
+    }
+    if (add && add->match == TopicMatch::Exact) {
+        ++exact;
+    } else if (add && add->match == TopicMatch::Range) {
+        ++ranges;
+    }
+    const size_t count = old_count + (add ? 1 : 0) - (removed < old_count ? 1 : 0);
+    if (count == 0) {
+        out = nullptr;
+        return true;
+    }
+
+    // Segment boundaries (every range start and every end + 1), followed by
+    // scratch space for the per-segment fill cursors.
+    uint32_t* bounds = nullptr;
+    size_t segments = 0;
+    size_t members  = 0;
+    if (ranges > 0) {
+        bounds = static_cast<uint32_t*>(malloc(4 * ranges * sizeof(uint32_t)));
+        if (!bounds) {
+            return false;
+        }
+        auto add_bounds = [&](const SubscriberRecord* r) {
+            bounds[segments++] = r->topic;
+            if (r->topic_last != UINT32_MAX) {
+                bounds[segments++] = r->topic_last + 1;
+            }
+        };
+        for (size_t i = old_exact; i < old_ranges; ++i) {
+            if (i != removed) {
+                add_bounds(src[i].record);
+            }
+        }
+        if (add && add->match == TopicMatch::Range) {
+            add_bounds(add);
+        }
+        std::sort(bounds, bounds + segments);
+        segments = std::unique(bounds, bounds + segments) - bounds;
+    }
+
+    // [first, end) segment indices covered by a range.
+    auto covered = [&](const SubscriberRecord* r, size_t& first, size_t& end) {
+        first = std::lower_bound(bounds, bounds + segments, r->topic) - bounds;
+        end   = r->topic_last == UINT32_MAX
+                    ? segments
+                    : std::lower_bound(bounds, bounds + segments, r->topic_last + 1) - bounds;
+    };
+    for (size_t i = old_exact; i < old_ranges; ++i) {
+        if (i != removed) {
+            size_t first, end;
+            covered(src[i].record, first, end);
+            members += end - first;
+        }
+    }
+    if (add && add->match == TopicMatch::Range) {
+        size_t first, end;
+        covered(add, first, end);
+        members += end - first;
+    }
+
+    SubscriberTable* table = AllocTable(count, members, segments);
+    if (!table) {
+        free(bounds);
+        return false;
+    }
+    table->exact_count = exact;
+    table->range_count = ranges;
+
+    // Copy the current slots section by section.  New exact and mask slots go
+    // to the upper bound of their key so equal keys keep subscription order;
+    // new ranges are appended.
+    TableSlot* dst = table->Slots();
+    auto copy = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) {
+            if (i != removed) {
+                src[i].record->refs.fetch_add(1, std::memory_order_relaxed);
+                *dst++ = src[i];
+            }
+        }
+    };
+    const TableSlot added = add ? TableSlot{add->topic, add->topic_mask, add} : TableSlot{};
+
+    size_t split = old_exact;
+    if (add && add->match == TopicMatch::Exact) {
+        split = std::upper_bound(src, src + old_exact, added,
+                                 [](const TableSlot& a, const TableSlot& b) {
+                                     return a.topic < b.topic;
+                                 }) - src;
+    }
+    copy(0, split);
+    if (add && add->match == TopicMatch::Exact) {
+        *dst++ = added;
+    }
+    copy(split, old_ranges);
+    if (add && add->match == TopicMatch::Range) {
+        *dst++ = added;
+    }
+    split = old_count;
+    if (add && add->match == TopicMatch::Mask) {
+        split = std::upper_bound(src + old_ranges, src + old_count, added,
+                                 [](const TableSlot& a, const TableSlot& b) {
+                                     return a.mask != b.mask ? a.mask < b.mask
+                                                             : a.topic < b.topic;
+                                 }) - src;
+    }
+    copy(old_ranges, split);
+    if (add && add->match == TopicMatch::Mask) {
+        *dst++ = added;
+    }
+    copy(split, old_count);
+
+    // Range index: count the ranges per segment, turn the counts into start
+    // offsets, then fill each segment in subscription order.
+    RangeSegment* seg = table->Segments();
+    for (size_t i = 0; i <= segments; ++i) {
+        seg[i] = RangeSegment{i < segments ? bounds[i] : 0, 0};
+    }
+    TableSlot* const range_slots = table->Slots() + exact;
+    for (size_t r = 0; r < ranges; ++r) {
+        size_t first, end;
+        covered(range_slots[r].record, first, end);
+        for (size_t i = first; i < end; ++i) {
+            ++seg[i].begin;
+        }
+    }
+    uint32_t* const cursor = bounds + 2 * ranges;
+    uint32_t offset = 0;
+    for (size_t i = 0; i <= segments; ++i) {
+        const uint32_t n = seg[i].begin;
+        seg[i].begin = offset;
+        if (i < segments) {
+            cursor[i] = offset;
+        }
+        offset += n;
+    }
+    SubscriberRecord** member = table->Members();
+    for (size_t r = 0; r < ranges; ++r) {
+        size_t first, end;
+        covered(range_slots[r].record, first, end);
+        for (size_t i = first; i < end; ++i) {
+            member[cursor[i]++] = range_slots[r].record;
+        }
+    }
+
+    free(bounds);
+    out = table;
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -45,13 +407,76 @@ esp_err_t MessageBus::Initialize(const BusConfig& config) {
 
     config_ = config;
 
+    // Every failure below goes through ReleaseResources(), which undoes the
+    // steps that already ran, so Initialize() can be retried.
     mutex_ = xSemaphoreCreateMutex();
     if (!mutex_) {
         ESP_LOGE(TAG, "Failed to create mutex");
         return ESP_ERR_NO_MEM;
     }
 
-    subscribers_.reserve(config_.max_subscribers);
+    if (!inflight_freed_ && !(inflight_freed_ = xSemaphoreCreateBinary())) {
+        ESP_LOGE(TAG, "Failed to create semaphore");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (payload_pool_.Init(config_.payload_pool, sizeof(AsyncPayload)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate payload pool");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
+#if LVGL_MSG_BUS_STATS
+    if (!InitStats()) {
+        ESP_LOGE(TAG, "Failed to allocate stats table");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+#if LVGL_MSG_BUS_TRACE
+    if (!InitTrace()) {
+        ESP_LOGE(TAG, "Failed to allocate trace ring");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    if (loan_pool_.Init(config_.loan_pool, sizeof(AsyncPayload)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate loan pool");
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (config_.lvgl_dispatch == LvglDispatch::Batched) {
+        for (auto& queue : lvgl_queues_) {
+            if (queue.Init(config_.lvgl_queue_depth) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to allocate LVGL dispatch queue");
+                ReleaseResources();
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+
+    if (config_.worker_count > 0 && StartWorkers() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start %u worker tasks", (unsigned)config_.worker_count);
+        ReleaseResources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (config_.isr_queue_depth > 0) {
+        if (isr_queue_.Init(config_.isr_queue_depth) != ESP_OK ||
+            xTaskCreatePinnedToCore(IsrTask, "msgbus_isr", config_.isr_task_stack,
+                                    this, config_.isr_task_priority, &isr_task_,
+                                    config_.isr_task_core) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start ISR fan-out task");
+            isr_task_ = nullptr;
+            ReleaseResources();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     initialized_ = true;
 
     ESP_LOGI(TAG, "Initialized (max_subscribers=%u, max_data=%u)",
@@ -65,15 +490,90 @@ esp_err_t MessageBus::Initialize(const BusConfig& config) {
 
 SubscriptionId MessageBus::Subscribe(uint32_t topic, MessageCallback cb,
                                      DeliveryMode mode,
-                                     uint32_t min_interval_ms) {
+                                     uint32_t min_interval_ms,
+                                     DeliveryPriority priority) {
+    SubscribeOptions options;
+    options.mode            = mode;
+    options.min_interval_ms = min_interval_ms;
+    options.priority        = priority;
+    return Subscribe(topic, std::move(cb), options);
+}
+
+SubscriptionId MessageBus::Subscribe(uint32_t topic, MessageCallback cb,
+                                     const SubscribeOptions& options) {
+    return AddSubscriber(TopicMatch::Exact, topic, topic, std::move(cb), options);
+}
+
+SubscriptionId MessageBus::SubscribeRange(uint32_t first, uint32_t last,
+                                          MessageCallback cb,
+                                          const SubscribeOptions& options) {
+    if (first > last) {
+        ESP_LOGW(TAG, "SubscribeRange: empty range 0x%04lx..0x%04lx",
+                 (unsigned long)first, (unsigned long)last);
+        return kInvalidSubscription;
+    }
+    return AddSubscriber(first == last ? TopicMatch::Exact : TopicMatch::Range,
+                         first, last, std::move(cb), options);
+}
+
+SubscriptionId MessageBus::SubscribeMask(uint32_t value, uint32_t mask,
+                                         MessageCallback cb,
+                                         const SubscribeOptions& options) {
+    const uint32_t wild = ~mask;
+    if ((wild & (wild + 1)) == 0) {
+        // Only low bits are free: the mask selects a contiguous range.
+        return SubscribeRange(value & mask, value | wild, std::move(cb), options);
+    }
+    return AddSubscriber(TopicMatch::Mask, value & mask, mask, std::move(cb), options);
+}
+
+SubscriptionId MessageBus::AddSubscriber(TopicMatch match, uint32_t topic, uint32_t arg,
+                                         MessageCallback cb,
+                                         const SubscribeOptions& options) {
     if (!initialized_ || !cb) {
         ESP_LOGW(TAG, "Subscribe failed: bus %s, callback %s",
                  initialized_ ? "ok" : "not init", cb ? "ok" : "null");
         return kInvalidSubscription;
     }
+    if (options.mode == DeliveryMode::Worker && !workers_) {
+        ESP_LOGW(TAG, "Subscribe failed: DeliveryMode::Worker needs worker_count > 0");
+        return kInvalidSubscription;
+    }
+
+    auto* record = new SubscriberRecord();
+    record->bus                 = this;
+    record->match               = match;
+    record->topic               = topic;
+    record->topic_last          = match == TopicMatch::Range ? arg : topic;
+    record->topic_mask          = match == TopicMatch::Mask ? arg : UINT32_MAX;
+    record->callback            = std::move(cb);
+    record->mode                = options.mode;
+    record->priority            = options.priority;
+    record->min_interval_ticks  =
+        options.min_interval_ms > 0 ? pdMS_TO_TICKS(options.min_interval_ms) : 0;
+    record->overflow            = options.overflow;
+    record->block_timeout_ticks = pdMS_TO_TICKS(options.block_timeout_ms);
+
+    // A capped LvglAsync subscriber queues its messages in a backlog of its
+    // own, so that DropOldest / Conflate can reach them.  Worker subscribers
+    // always have one: it is the queue their worker drains, in order.
+    const uint32_t backlog = options.mode == DeliveryMode::Worker && options.max_inflight == 0
+                                 ? static_cast<uint32_t>(config_.worker_queue_depth)
+                                 : options.max_inflight;
+    if ((options.mode == DeliveryMode::LvglAsync || options.mode == DeliveryMode::Worker) &&
+        backlog > 0) {
+        if (record->backlog.Init(backlog) != ESP_OK) {
+            ESP_LOGE(TAG, "Subscribe: backlog alloc failed (%lu entries)",
+                     (unsigned long)backlog);
+            delete record;
+            return kInvalidSubscription;
+        }
+        record->max_inflight = backlog;
+    }
 
     if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Subscribe: mutex timeout");
+        delete record;
         return kInvalidSubscription;
     }
 
@@ -82,18 +582,59 @@ SubscriptionId MessageBus::Subscribe(uint32_t topic, MessageCallback cb,
     if (next_id_ == kInvalidSubscription) {
         next_id_ = 1;
     }
+    record->id = id;
+    if (options.mode == DeliveryMode::Worker) {
+        record->worker = options.worker >= 0 ? static_cast<uint32_t>(options.worker)
+                                             : next_worker_++;
+        record->worker %= static_cast<uint32_t>(config_.worker_count);
+    }
 
-    const uint32_t interval_ticks =
-        min_interval_ms > 0 ? pdMS_TO_TICKS(min_interval_ms) : 0;
+    SubscriberTable* current = table_.load(std::memory_order_relaxed);
+    SubscriberTable* table   = nullptr;
+    if (!BuildTable(current, record, kInvalidSubscription, table)) {
+        xSemaphoreGive(mutex_);
+        ESP_LOGE(TAG, "Subscribe: table alloc failed (%u entries)",
+                 (unsigned)((current ? current->count : 0) + 1));
+        delete record;
+        return kInvalidSubscription;
+    }
+
+    SubscriberTable* old = SwapTable(table);
 
-    subscribers_.push_back(
-        {id, topic, std::move(cb), mode, interval_ticks, 0});
+    // Retained values: LVGL-thread subscribers share one replay callback,
+    // Immediate and Worker ones get theirs below.  The extra reference keeps
+    // the record alive across a concurrent Unsubscribe().
+    bool schedule_replay = false;
+    bool replay_now      = false;
+    if (retained_count_.load(std::memory_order_relaxed) > 0) {
+        if (options.mode != DeliveryMode::Immediate &&
+            options.mode != DeliveryMode::Worker) {
+            schedule_replay = QueueReplay(record);
+        } else {
+            record->refs.fetch_add(1, std::memory_order_relaxed);
+            replay_now = true;
+        }
+    }
 
     xSemaphoreGive(mutex_);
 
-    ESP_LOGD(TAG, "Subscribed id=%lu topic=0x%04lx mode=%d interval=%lums",
-             (unsigned long)id, (unsigned long)topic,
-             static_cast<int>(mode), (unsigned long)min_interval_ms);
+    if (old) {
+        ReleaseTable(old);
+    }
+    if (schedule_replay) {
+        lv_async_call(ReplayCb, this);
+    }
+    if (replay_now) {
+        ReplayRetained(record);
+        ReleaseRecord(record);
+    }
+
+    ESP_LOGD(TAG, "Subscribed id=%lu topic=0x%04lx/%d/0x%04lx mode=%d prio=%d "
+                  "interval=%lums max_inflight=%lu",
+             (unsigned long)id, (unsigned long)topic, static_cast<int>(match),
+             (unsigned long)arg, static_cast<int>(options.mode),
+             static_cast<int>(options.priority), (unsigned long)options.min_interval_ms,
+             (unsigned long)record->max_inflight);
     return id;
 }
 
@@ -101,25 +642,51 @@ SubscriptionId MessageBus::Subscribe(uint32_t topic, MessageCallback cb,
 // Unsubscribe
 // ---------------------------------------------------------------------------
 
-void MessageBus::Unsubscribe(SubscriptionId id) {
-    if (id == kInvalidSubscription || !initialized_) {
-        return;
+esp_err_t MessageBus::Unsubscribe(SubscriptionId id) {
+    if (id == kInvalidSubscription) {
+        return ESP_OK;
+    }
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
     }
 
     if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Unsubscribe: mutex timeout");
-        return;
+        return ESP_ERR_TIMEOUT;
     }
 
-    for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
-        if (it->id == id) {
-            subscribers_.erase(it);
-            ESP_LOGD(TAG, "Unsubscribed id=%lu", (unsigned long)id);
-            break;
-        }
+    SubscriberTable* current = table_.load(std::memory_order_relaxed);
+    const size_t old_count = current ? current->count : 0;
+    TableSlot* src = current ? current->Slots() : nullptr;
+    size_t index = 0;
+    while (index < old_count && src[index].record->id != id) {
+        ++index;
+    }
+    if (index == old_count) {
+        xSemaphoreGive(mutex_);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Build the new table first: if that fails the subscription stays fully
+    // active and the caller can retry.
+    SubscriberTable* table = nullptr;
+    if (!BuildTable(current, nullptr, id, table)) {
+        xSemaphoreGive(mutex_);
+        ESP_LOGE(TAG, "Unsubscribe: table alloc failed");
+        return ESP_ERR_NO_MEM;
     }
 
+    // Queued deliveries hold the record, so this one check cancels all of
+    // them; they are freed as they are drained.
+    src[index].record->active.store(false, std::memory_order_release);
+    SubscriberTable* old = SwapTable(table);
+
     xSemaphoreGive(mutex_);
+
+    // Publishers still iterating the old table keep its records alive.
+    ReleaseTable(old);
+    ESP_LOGD(TAG, "Unsubscribed id=%lu", (unsigned long)id);
+    return ESP_OK;
 }
 
 // ---------------------------------------------------------------------------
@@ -137,77 +704,670 @@ void MessageBus::Publish(uint32_t topic, const void* data, size_t size) {
         size = config_.max_data_size;
     }
 
-    const uint32_t now = xTaskGetTickCount();
+    Dispatch(topic, data, size, xTaskGetTickCount(), nullptr);
+}
 
-    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        ESP_LOGE(TAG, "Publish: mutex timeout");
+void MessageBus::PublishExact(uint32_t topic, const void* data, size_t size) {
+    // Typed topics: truncating a struct would corrupt it, so refuse instead.
+    if (!initialized_) {
         return;
     }
 
-    // Snapshot matching subscribers while holding the lock.
-    // Use a small local vector to avoid allocation in the hot path for
-    // typical subscriber counts.  If there are more, it will heap-allocate.
-    std::vector<SubscriberEntry> matches;
-    matches.reserve(4);
-    for (auto& sub : subscribers_) {
-        if (sub.topic == topic) {
-            // Per-subscriber throttle: skip if interval not yet elapsed.
-            if (sub.min_interval_ticks > 0) {
-                const uint32_t elapsed = now - sub.last_delivery_tick;
-                if (elapsed < sub.min_interval_ticks) {
-                    continue;
-                }
-            }
-            sub.last_delivery_tick = now;
-            matches.push_back(sub);
+    if (size > config_.max_data_size) {
+        ESP_LOGW(TAG, "Typed payload on 0x%04lx too large (%u > %u), dropped",
+                 (unsigned long)topic, (unsigned)size, (unsigned)config_.max_data_size);
+        return;
+    }
+
+    Dispatch(topic, data, size, xTaskGetTickCount(), nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// PublishMany (one snapshot, one LVGL dispatch)
+// ---------------------------------------------------------------------------
+
+void MessageBus::PublishMany(const PublishEntry* entries, size_t count) {
+    if (!initialized_ || !entries || count == 0) {
+        return;
+    }
+
+    const uint32_t now = xTaskGetTickCount();
+    SubscriberTable* table = AcquireTable();
+    DeliveryBatch batch;
+    for (size_t i = 0; i < count; ++i) {
+        size_t size = entries[i].size;
+        if (size > config_.max_data_size) {
+            ESP_LOGW(TAG, "Payload too large (%u > %u), truncated",
+                     (unsigned)size, (unsigned)config_.max_data_size);
+            size = config_.max_data_size;
         }
+        DispatchTo(table, entries[i].topic, entries[i].data, size, now, nullptr, &batch);
+    }
+    if (table) {
+        ReleaseTable(table);
     }
 
-    xSemaphoreGive(mutex_);
+    if (batch.head && lv_async_call(LvglBatchCb, batch.head) != LV_RESULT_OK) {
+        ESP_LOGE(TAG, "PublishMany: lv_async_call failed, frame dropped");
+        DropBatch(batch.head);
+    }
+}
+
+void MessageBus::DropBatch(BatchChunk* chunk) {
+    // Undo what QueueAsync() took for each delivery: the in-flight slot, the
+    // record reference and the payload reference.
+    while (chunk) {
+        for (size_t i = 0; i < chunk->count; ++i) {
+            const PendingDelivery& item = chunk->items[i];
+            Trace(TraceEvent::Evict, item.payload->topic, item.record->id,
+                  item.payload->data_size);
+            DropPayload(item.record, item.payload, alloc_failures_);
+            ReleaseRecord(item.record);
+            ReleaseInflight();
+        }
+        BatchChunk* next = chunk->next;
+        payload_pool_.Free(chunk);
+        chunk = next;
+    }
+}
+
+bool MessageBus::AppendToBatch(DeliveryBatch& batch, SubscriberRecord* record,
+                               AsyncPayload* payload) {
+    BatchChunk* chunk = batch.tail;
+    if (!chunk || chunk->count == BatchChunk::kCapacity) {
+        chunk = static_cast<BatchChunk*>(payload_pool_.Alloc(sizeof(BatchChunk)));
+        if (!chunk) {
+            return false;  // Deliver this one on its own instead.
+        }
+        chunk->bus   = this;
+        chunk->next  = nullptr;
+        chunk->count = 0;
+        (batch.tail ? batch.tail->next : batch.head) = chunk;
+        batch.tail = chunk;
+    }
+    chunk->items[chunk->count++] = PendingDelivery{record, payload};
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PublishFromISR (deferred fan-out)
+// ---------------------------------------------------------------------------
+
+bool MessageBus::PublishFromISR(uint32_t topic, const void* data, size_t size,
+                                BaseType_t* woken) {
+    if (!initialized_ || !isr_task_ || size > kMaxIsrDataSize) {
+        return false;
+    }
+
+    IsrMessage msg;
+    msg.topic     = topic;
+    msg.timestamp = xTaskGetTickCountFromISR();
+    msg.data_size = static_cast<uint32_t>(data ? size : 0);
+    if (msg.data_size > 0) {
+        memcpy(msg.data, data, msg.data_size);
+    }
+    if (!isr_queue_.TryPush(msg)) {
+        return false;
+    }
+
+    vTaskNotifyGiveFromISR(isr_task_, woken);
+    return true;
+}
+
+void MessageBus::IsrTask(void* arg) {
+    auto* bus = static_cast<MessageBus*>(arg);
+    IsrMessage msg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (bus->isr_queue_.TryPop(msg)) {
+            bus->Dispatch(msg.topic, msg.data_size > 0 ? msg.data : nullptr,
+                          msg.data_size, msg.timestamp, nullptr);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// LoanBuffer / Commit (zero-copy publish)
+// ---------------------------------------------------------------------------
+
+LoanedBuffer MessageBus::LoanBuffer(uint32_t topic, size_t size) {
+    if (!initialized_) {
+        return {};
+    }
+
+    const size_t alloc_size = sizeof(AsyncPayload) + size;
+    void* mem = loan_pool_.Alloc(alloc_size);
+    if (!mem) {
+        ESP_LOGE(TAG, "Loan alloc failed (%u bytes)", (unsigned)alloc_size);
+        return {};
+    }
+
+    auto* payload      = new (mem) AsyncPayload();
+    payload->bus       = this;
+    payload->topic     = topic;
+    payload->timestamp = 0;
+    payload->data_size = size;
+    return LoanedBuffer(payload, payload->DataPtr(), size, topic);
+}
+
+void MessageBus::Commit(LoanedBuffer&& buffer) {
+    auto* payload = static_cast<AsyncPayload*>(buffer.payload_);
+    if (!payload) {
+        return;
+    }
+    buffer.payload_ = nullptr;
+    buffer.data_    = nullptr;
+    buffer.size_    = 0;
+
+    // The loan's reference becomes the publisher's reference in Dispatch().
+    payload->timestamp = xTaskGetTickCount();
+#if LVGL_MSG_BUS_STATS
+    payload->publish_us = esp_timer_get_time();
+#endif
+    Dispatch(payload->topic, payload->DataPtr(), payload->data_size,
+             payload->timestamp, payload);
+}
+
+void MessageBus::ReleaseLoan(void* payload) {
+    ReleasePayload(static_cast<AsyncPayload*>(payload));
+}
+
+// ---------------------------------------------------------------------------
+// Dispatch (shared by Publish and Commit)
+// ---------------------------------------------------------------------------
+
+void MessageBus::Dispatch(uint32_t topic, const void* data, size_t size,
+                          uint32_t now, AsyncPayload* shared) {
+    // Pin the current subscriber table without taking any lock.  The table is
+    // immutable, so it is iterated in place without copying any entries or
+    // callbacks.
+    SubscriberTable* table = AcquireTable();
+    DispatchTo(table, topic, data, size, now, shared, nullptr);
+    if (table) {
+        ReleaseTable(table);
+    }
+}
+
+void MessageBus::DispatchTo(SubscriberTable* table, uint32_t topic, const void* data,
+                            size_t size, uint32_t now, AsyncPayload* shared,
+                            DeliveryBatch* batch) {
+    Trace(TraceEvent::Publish, topic, 0, size);
+    if (retained_count_.load(std::memory_order_relaxed) > 0) {
+        StoreRetained(topic, data, size, now);
+    }
+
+#if LVGL_MSG_BUS_STATS
+    TopicCounters* stats = TopicStatsFor(topic);
+    if (stats) {
+        stats->publishes.fetch_add(1, std::memory_order_relaxed);
+        stats->bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    uint32_t fanout = 0;
+#endif
 
-    if (matches.empty()) {
+    if (!table) {
+        // No subscribers at all.
+        if (shared) {
+            ReleasePayload(shared);
+        }
         return;
     }
 
-    // Deliver to each matching subscriber outside the lock.
-    for (const auto& sub : matches) {
-        if (sub.mode == DeliveryMode::Immediate) {
+    bool alloc_failed = false;
+
+    // Deliver to one matching subscriber.
+    auto deliver = [&](SubscriberRecord* sub) {
+        if (!sub->active.load(std::memory_order_acquire)) {
+            return;   // Unsubscribed while this publish held the old table.
+        }
+
+        // Per-subscriber throttle: skip if interval not yet elapsed.  The
+        // compare-exchange lets concurrent publishers claim a slot only once.
+        uint32_t last = sub->last_delivery_tick.load(std::memory_order_relaxed);
+        bool throttled = false;
+        do {
+            if (sub->min_interval_ticks > 0 &&
+                now - last < sub->min_interval_ticks) {
+                throttled = true;
+                break;
+            }
+        } while (!sub->last_delivery_tick.compare_exchange_weak(
+                     last, now, std::memory_order_relaxed));
+        if (throttled) {
+            Trace(TraceEvent::Throttle, topic, sub->id, size);
+#if LVGL_MSG_BUS_STATS
+            if (stats) {
+                stats->throttled.fetch_add(1, std::memory_order_relaxed);
+            }
+#endif
+            return;
+        }
+
+        if (sub->mode == DeliveryMode::Immediate) {
             // Synchronous delivery in caller's thread.
             Message msg{topic, data, size, now};
-            sub.callback(msg);
-        } else {
-            // Asynchronous delivery via LVGL thread.
-            const size_t alloc_size = sizeof(AsyncPayload) + size;
-            auto* payload = static_cast<AsyncPayload*>(malloc(alloc_size));
-            if (!payload) {
-                ESP_LOGE(TAG, "Async alloc failed (%u bytes)", (unsigned)alloc_size);
-                continue;
+            Trace(TraceEvent::DispatchBegin, topic, sub->id, size);
+#if LVGL_MSG_BUS_STATS
+            const int64_t start_us = esp_timer_get_time();
+            sub->callback(msg);
+            sub->exec.Add(static_cast<uint32_t>(esp_timer_get_time() - start_us));
+            ++fanout;
+            if (stats) {
+                stats->delivered.fetch_add(1, std::memory_order_relaxed);
+            }
+#else
+            sub->callback(msg);
+#endif
+            Trace(TraceEvent::DispatchEnd, topic, sub->id, size);
+            return;
+        }
+
+        // Asynchronous delivery via the LVGL thread or a worker.  One payload
+        // copy is made on the first async match (or loaned up front) and shared (refcounted)
+        // by all of them.
+        if (!shared && !alloc_failed) {
+            shared = AllocPayload(topic, data, size, now);
+            alloc_failed = !shared;
+        }
+        if (!shared) {
+            Trace(TraceEvent::Drop, topic, sub->id, size);
+#if LVGL_MSG_BUS_STATS
+            if (stats) {
+                stats->dropped.fetch_add(1, std::memory_order_relaxed);
             }
+#endif
+            return;
+        }
+        shared->refs.fetch_add(1, std::memory_order_relaxed);
+#if LVGL_MSG_BUS_STATS
+        ++fanout;
+#endif
 
-            // Placement-construct the callback (std::function).
-            new (&payload->callback) MessageCallback(sub.callback);
-            payload->topic     = topic;
-            payload->timestamp = now;
-            payload->data_size = size;
-            if (size > 0 && data) {
-                memcpy(payload->DataPtr(), data, size);
+        if (sub->mode == DeliveryMode::LvglLatest) {
+            // Replace the pending message; only an empty slot needs a
+            // wake-up, which holds a record reference.
+            AsyncPayload* stale =
+                sub->pending.exchange(shared, std::memory_order_acq_rel);
+            Trace(stale ? TraceEvent::Replace : TraceEvent::Enqueue, topic, sub->id, size);
+            if (stale) {
+                ReleasePayload(stale);
+            } else {
+                sub->refs.fetch_add(1, std::memory_order_relaxed);
+                DispatchAsync(sub, nullptr);
             }
+        } else {
+            QueueAsync(sub, shared, batch);
+        }
+    };
+
+    // Exact slots are sorted by topic, so only the matching run is visited.
+    TableSlot* const slots = table->Slots();
+    TableSlot* const exact = slots + table->exact_count;
+    for (TableSlot* it = std::lower_bound(
+             slots, exact, topic,
+             [](const TableSlot& e, uint32_t t) { return e.topic < t; });
+         it != exact && it->topic == topic; ++it) {
+        deliver(it->record);
+    }
+
+    // Ranges: the segment holding the topic lists every range covering it.
+    RangeSegment* const segs = table->Segments();
+    RangeSegment* seg = std::upper_bound(
+        segs, segs + table->segment_count, topic,
+        [](uint32_t t, const RangeSegment& e) { return t < e.start; });
+    if (seg != segs) {
+        SubscriberRecord** members = table->Members();
+        for (uint32_t i = (seg - 1)->begin; i < seg->begin; ++i) {
+            deliver(members[i]);
+        }
+    }
+
+    // Masks: one binary search per distinct mask.
+    TableSlot* const end = slots + table->count;
+    for (TableSlot* group = exact + table->range_count; group != end;) {
+        const uint32_t mask = group->mask;
+        TableSlot* const group_end = std::upper_bound(
+            group, end, mask,
+            [](uint32_t m, const TableSlot& e) { return m < e.mask; });
+        const uint32_t value = topic & mask;
+        for (TableSlot* it = std::lower_bound(
+                 group, group_end, value,
+                 [](const TableSlot& e, uint32_t v) { return e.topic < v; });
+             it != group_end && it->topic == value; ++it) {
+            deliver(it->record);
+        }
+        group = group_end;
+    }
 
-            lv_async_call(LvglAsyncCb, payload);
+#if LVGL_MSG_BUS_STATS
+    if (stats) {
+        uint32_t peak = stats->peak_fanout.load(std::memory_order_relaxed);
+        while (fanout > peak &&
+               !stats->peak_fanout.compare_exchange_weak(peak, fanout,
+                                                         std::memory_order_relaxed)) {
         }
     }
+#endif
+
+    if (shared) {
+        // Drop the publisher's reference; the last delivery frees the block.
+        ReleasePayload(shared);
+    }
 }
 
 // ---------------------------------------------------------------------------
-// LVGL async callback (runs in LVGL task)
+// In-flight caps (LvglAsync)
 // ---------------------------------------------------------------------------
 
-void MessageBus::LvglAsyncCb(void* user_data) {
-    auto* payload = static_cast<AsyncPayload*>(user_data);
+void MessageBus::QueueAsync(SubscriberRecord* record, AsyncPayload* payload,
+                            DeliveryBatch* batch) {
+    // The caller already took the payload reference for this delivery.
+    if (!ReserveDelivery(record)) {
+        Trace(TraceEvent::Drop, payload->topic, record->id, payload->data_size);
+        DropPayload(record, payload, record->overflow == OverflowPolicy::Block
+                                         ? block_timeouts_ : dropped_newest_);
+        return;
+    }
+    Trace(TraceEvent::Enqueue, payload->topic, record->id, payload->data_size);
+
+    if (!record->backlog.IsValid()) {
+        // The delivery keeps the record (and its callback) alive.
+        record->refs.fetch_add(1, std::memory_order_relaxed);
+        if (!batch || !AppendToBatch(*batch, record, payload)) {
+            DispatchAsync(record, payload);
+        }
+        return;
+    }
+
+    // Reserved entries never exceed the backlog capacity, so the push fits.
+    record->backlog.TryPush(payload);
+    if (!record->wake_armed.exchange(true, std::memory_order_acq_rel)) {
+        record->refs.fetch_add(1, std::memory_order_relaxed);
+        DispatchAsync(record, nullptr);
+    }
+}
+
+bool MessageBus::TryReserveDelivery(SubscriberRecord* record) {
+    const uint32_t inflight = inflight_.fetch_add(1, std::memory_order_acq_rel);
+    if (config_.max_inflight > 0 && inflight >= config_.max_inflight) {
+        inflight_.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    if (!record->backlog.IsValid() ||
+        record->backlog_count.fetch_add(1, std::memory_order_acq_rel) < record->max_inflight) {
+        return true;
+    }
+    record->backlog_count.fetch_sub(1, std::memory_order_acq_rel);
+    if (EvictBacklog(record)) {
+        return true;
+    }
+    inflight_.fetch_sub(1, std::memory_order_acq_rel);
+    return false;
+}
+
+bool MessageBus::ReserveDelivery(SubscriberRecord* record) {
+    if (TryReserveDelivery(record)) {
+        return true;
+    }
+    if (record->overflow != OverflowPolicy::Block) {
+        return false;
+    }
+
+    const TickType_t start   = xTaskGetTickCount();
+    const TickType_t timeout = record->block_timeout_ticks;
+    bool ok = false;
+    inflight_waiters_.fetch_add(1, std::memory_order_acq_rel);
+    // Re-check after registering as a waiter so a delivery completing in
+    // between is not missed.
+    while (!(ok = TryReserveDelivery(record))) {
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout ||
+            xSemaphoreTake(inflight_freed_, timeout - elapsed) != pdTRUE) {
+            break;
+        }
+    }
+    inflight_waiters_.fetch_sub(1, std::memory_order_acq_rel);
+    return ok;
+}
+
+bool MessageBus::EvictBacklog(SubscriberRecord* record) {
+    // Called with a bus-wide reservation held and the backlog full.
+    AsyncPayload* victim = nullptr;
+    switch (record->overflow) {
+    case OverflowPolicy::DropOldest:
+        if (!record->backlog.TryPop(victim)) {
+            return false;  // The LVGL task just took it; room appears shortly.
+        }
+        // The victim's backlog entry passes to the new message.
+        Trace(TraceEvent::Evict, victim->topic, record->id, victim->data_size);
+        DropPayload(record, victim, dropped_oldest_);
+        ReleaseInflight();
+        return true;
+
+    case OverflowPolicy::Conflate:
+        while (record->backlog.TryPop(victim)) {
+            record->backlog_count.fetch_sub(1, std::memory_order_acq_rel);
+            Trace(TraceEvent::Evict, victim->topic, record->id, victim->data_size);
+            DropPayload(record, victim, conflated_);
+            ReleaseInflight();
+        }
+        if (record->backlog_count.fetch_add(1, std::memory_order_acq_rel) < record->max_inflight) {
+            return true;
+        }
+        record->backlog_count.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+void MessageBus::ReleaseInflight() {
+    inflight_.fetch_sub(1, std::memory_order_acq_rel);
+    if (inflight_waiters_.load(std::memory_order_acquire) > 0) {
+        xSemaphoreGive(inflight_freed_);
+    }
+}
+
+void MessageBus::DropPayload(SubscriberRecord* record, AsyncPayload* payload,
+                             std::atomic<uint32_t>& counter) {
+    record->dropped.fetch_add(1, std::memory_order_relaxed);
+    counter.fetch_add(1, std::memory_order_relaxed);
+    CountDropped(payload->topic);
+    ReleasePayload(payload);
+}
+
+void MessageBus::DrainBacklog(SubscriberRecord* record) {
+    // Runs in the LVGL task or the record's worker for a backlog wake-up.
+    // One message per wake-up keeps the drain fair and inside lvgl_batch_size.
+    AsyncPayload* payload = nullptr;
+    bool popped = record->backlog.TryPop(payload);
+    record->wake_armed.store(false, std::memory_order_seq_cst);
+
+    // A producer that pushed while the flag was still set relies on this
+    // wake-up; one that is still mid-push re-arms the flag itself.
+    if (!popped) {
+        popped = record->backlog.TryPop(payload);
+    }
+    if (popped) {
+        record->backlog_count.fetch_sub(1, std::memory_order_acq_rel);
+        Deliver(record, payload);
+        ReleasePayload(payload);
+        ReleaseInflight();
+    }
+    // An empty wake-up never re-arms: the producer still pushing arms the
+    // next one, so a half-published cell cannot make the drain spin.
+    if (popped && record->backlog.SizeApprox() > 0 &&
+        !record->wake_armed.exchange(true, std::memory_order_acq_rel)) {
+        record->refs.fetch_add(1, std::memory_order_relaxed);
+        DispatchAsync(record, nullptr);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// LVGL dispatch
+// ---------------------------------------------------------------------------
+
+void MessageBus::DispatchAsync(SubscriberRecord* record, AsyncPayload* payload) {
+    if (record->mode == DeliveryMode::Worker) {
+        WakeWorker(record);   // Always a backlog wake-up (payload == nullptr).
+        return;
+    }
+
+    auto& queue = lvgl_queues_[static_cast<size_t>(record->priority)];
+    if (queue.IsValid()) {
+        // Backlog wake-ups are never shed: the backlog itself is bounded and
+        // its entries still hold in-flight reservations.
+        const bool sheddable = record->priority == DeliveryPriority::Low &&
+                               config_.lvgl_shed_watermark > 0 &&
+                               (payload || !record->backlog.IsValid());
+        if (sheddable && LvglQueueDepth() >= config_.lvgl_shed_watermark) {
+            ShedDelivery(record, payload);
+            return;
+        }
+        if (queue.TryPush(PendingDelivery{record, payload})) {
+            // Only the first delivery of a burst schedules a drain.
+            // seq_cst pairs with the fence in DrainLvglQueue(): either the
+            // drain sees this push or this exchange sees the cleared flag.
+            if (!drain_scheduled_.exchange(true, std::memory_order_seq_cst)) {
+                lv_async_call(LvglDrainCb, this);
+            }
+            return;
+        }
+        if (sheddable) {
+            ShedDelivery(record, payload);
+            return;
+        }
+        // Ring full: fall back to a dedicated async call so nothing is lost.
+        ESP_LOGD(TAG, "LVGL queue full, dispatching directly");
+    }
     if (!payload) {
+        lv_async_call(LvglWakeCb, record);
+        return;
+    }
+
+    // lv_async_call() carries a single pointer, so pair record and payload
+    // in a small pool block.
+    auto* node = static_cast<PendingDelivery*>(payload_pool_.Alloc(sizeof(PendingDelivery)));
+    if (!node) {
+        alloc_failures_.fetch_add(1, std::memory_order_relaxed);
+        Trace(TraceEvent::Evict, payload->topic, record->id, payload->data_size);
+        CountDropped(payload->topic);
+        ESP_LOGE(TAG, "Async alloc failed (%u bytes)", (unsigned)sizeof(PendingDelivery));
+        FinishDelivery(record, payload);
+        return;
+    }
+    *node = PendingDelivery{record, payload};
+    lv_async_call(LvglAsyncCb, node);
+}
+
+void MessageBus::ShedDelivery(SubscriberRecord* record, AsyncPayload* payload) {
+    lvgl_shed_.fetch_add(1, std::memory_order_relaxed);
+    if (payload) {
+        Trace(TraceEvent::Evict, payload->topic, record->id, payload->data_size);
+        CountDropped(payload->topic);
+        FinishDelivery(record, payload);
         return;
     }
 
+    // An LvglLatest wake-up holds a record reference but no in-flight slot.
+    // Empty the pending slot again so the next publish queues a fresh
+    // wake-up instead of waiting for this one.
+    payload = record->pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (payload) {
+        Trace(TraceEvent::Evict, payload->topic, record->id, payload->data_size);
+        CountDropped(payload->topic);
+        ReleasePayload(payload);
+    }
+    ReleaseRecord(record);
+}
+
+size_t MessageBus::LvglQueueDepth() const {
+    // Racy but bounded: each ring reports at most its capacity, so a
+    // concurrent push / pop can skew the sum by a few entries, never wrap it.
+    size_t depth = 0;
+    for (const auto& queue : lvgl_queues_) {
+        depth += queue.SizeApprox();
+    }
+    return depth;
+}
+
+bool MessageBus::PopLvglDelivery(PendingDelivery& out) {
+    for (auto& queue : lvgl_queues_) {
+        if (queue.TryPop(out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MessageBus::LvglDrainCb(void* user_data) {
+    static_cast<MessageBus*>(user_data)->DrainLvglQueue();
+}
+
+void MessageBus::LvglDrainTimerCb(lv_timer_t* timer) {
+    static_cast<MessageBus*>(lv_timer_get_user_data(timer))->DrainLvglQueue();
+}
+
+void MessageBus::ContinueLvglDrain() {
+    // A 0 ms lv_async_call() would run again in the same lv_timer_handler()
+    // pass, so use a one-shot 1 ms timer to yield to rendering first.
+    lv_timer_t* timer = lv_timer_create(LvglDrainTimerCb, 1, this);
+    if (timer) {
+        lv_timer_set_repeat_count(timer, 1);
+    } else {
+        lv_async_call(LvglDrainCb, this);
+    }
+}
+
+void MessageBus::DrainLvglQueue() {
+    const int64_t start = esp_timer_get_time();
+    size_t delivered = 0;
+
+    PendingDelivery item{};
+    while (PopLvglDelivery(item)) {
+        // High deliveries do not count against the batch / time budget.
+        const bool high = item.record->priority == DeliveryPriority::High;
+        if (item.payload) {
+            Deliver(item.record, item.payload);
+            FinishDelivery(item.record, item.payload);
+        } else {
+            LvglWakeCb(item.record);
+        }
+        if (high) {
+            continue;
+        }
+        ++delivered;
+
+        const bool batch_full = config_.lvgl_batch_size > 0 &&
+                                delivered >= config_.lvgl_batch_size;
+        const bool over_budget =
+            config_.lvgl_drain_budget_us > 0 &&
+            esp_timer_get_time() - start >= config_.lvgl_drain_budget_us;
+        if (batch_full || over_budget) {
+            ContinueLvglDrain();
+            return;
+        }
+    }
+
+    // Queue looks empty: clear the flag, then re-check so a push that raced
+    // with the last TryPop() is not stranded.  The fence keeps the re-check
+    // from being satisfied before the store is visible (store -> load needs a
+    // full barrier).  A producer may still be between claiming and publishing
+    // its cell, so retry later instead of spinning.
+    drain_scheduled_.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (LvglQueueDepth() != 0 &&
+        !drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        ContinueLvglDrain();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// LVGL async callback (runs in LVGL task)
+// ---------------------------------------------------------------------------
+
+void MessageBus::Deliver(SubscriberRecord* record, const AsyncPayload* payload) {
     Message msg{
         payload->topic,
         payload->data_size > 0 ? payload->DataPtr() : nullptr,
@@ -215,13 +1375,79 @@ void MessageBus::LvglAsyncCb(void* user_data) {
         payload->timestamp,
     };
 
-    if (payload->callback) {
-        payload->callback(msg);
+    if (!record->active.load(std::memory_order_acquire) || !record->callback) {
+        return;   // Unsubscribed after the message was queued.
+    }
+
+    MessageBus* bus = record->bus;
+    bus->Trace(TraceEvent::DispatchBegin, msg.topic, record->id, msg.data_size);
+#if LVGL_MSG_BUS_STATS
+    const int64_t start_us = esp_timer_get_time();
+    record->latency.Add(static_cast<uint32_t>(start_us - payload->publish_us));
+    record->callback(msg);
+    record->exec.Add(static_cast<uint32_t>(esp_timer_get_time() - start_us));
+    if (TopicCounters* stats = bus->TopicStatsFor(payload->topic)) {
+        stats->delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+#else
+    record->callback(msg);
+#endif
+    bus->Trace(TraceEvent::DispatchEnd, msg.topic, record->id, msg.data_size);
+}
+
+void MessageBus::LvglAsyncCb(void* user_data) {
+    auto* node = static_cast<PendingDelivery*>(user_data);
+    if (!node) {
+        return;
     }
 
-    // Destroy the std::function and free the block.
-    payload->callback.~MessageCallback();
-    free(payload);
+    const PendingDelivery item = *node;
+    MessageBus* bus = item.record->bus;
+    bus->payload_pool_.Free(node);
+
+    Deliver(item.record, item.payload);
+    bus->FinishDelivery(item.record, item.payload);
+}
+
+void MessageBus::LvglBatchCb(void* user_data) {
+    auto* chunk = static_cast<BatchChunk*>(user_data);
+    while (chunk) {
+        MessageBus* bus = chunk->bus;
+        for (size_t i = 0; i < chunk->count; ++i) {
+            const PendingDelivery& item = chunk->items[i];
+            Deliver(item.record, item.payload);
+            bus->FinishDelivery(item.record, item.payload);
+        }
+        BatchChunk* next = chunk->next;
+        bus->payload_pool_.Free(chunk);
+        chunk = next;
+    }
+}
+
+void MessageBus::LvglWakeCb(void* user_data) {
+    auto* record = static_cast<SubscriberRecord*>(user_data);
+
+    if (record->backlog.IsValid()) {
+        record->bus->DrainBacklog(record);
+        ReleaseRecord(record);
+        return;
+    }
+
+    // LvglLatest: take the newest message; a publish after this point queues a new wake-up.
+    AsyncPayload* payload = record->pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (payload) {
+        Deliver(record, payload);
+        ReleasePayload(payload);
+    }
+
+    // Drop the wake-up's own reference.
+    ReleaseRecord(record);
+}
+
+void MessageBus::FinishDelivery(SubscriberRecord* record, AsyncPayload* payload) {
+    ReleaseRecord(record);
+    ReleasePayload(payload);
+    ReleaseInflight();
 }
 
 } // namespace msgbus
@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * MessageBus retained topics: last-value storage and replay to new subscribers.
+ */
+
+#include "lvgl_msg_bus/message_bus.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+static const char* TAG = "MsgBusRetain";
+
+namespace msgbus {
+
+// ---------------------------------------------------------------------------
+// Storage
+// ---------------------------------------------------------------------------
+
+bool MessageBus::InitRetained() {
+    // Called with mutex_ held, on the first Retain().
+    if (retained_block_) {
+        return true;
+    }
+    const size_t topics = config_.retained_topics;
+    const size_t ids    = (topics * sizeof(uint32_t) + 7) & ~size_t(7);
+    const size_t values = topics * sizeof(RetainedValue);
+    retained_mutex_ = xSemaphoreCreateMutex();
+    if (!retained_mutex_) {
+        return false;
+    }
+    retained_block_ = static_cast<uint8_t*>(heap_caps_malloc(
+        ids + values + config_.retained_arena_size, config_.payload_pool.caps));
+    if (!retained_block_) {
+        vSemaphoreDelete(retained_mutex_);
+        retained_mutex_ = nullptr;
+        return false;
+    }
+    retained_ids_   = reinterpret_cast<uint32_t*>(retained_block_);
+    retained_       = reinterpret_cast<RetainedValue*>(retained_block_ + ids);
+    retained_arena_ = retained_block_ + ids + values;
+    return true;
+}
+
+esp_err_t MessageBus::Retain(uint32_t topic, size_t max_size) {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Retain: mutex timeout");
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = ESP_OK;
+    const uint32_t count = retained_count_.load(std::memory_order_relaxed);
+    const size_t   bytes = (max_size + 3) & ~size_t(3);
+    if (FindRetained(topic) >= 0) {
+        // Already retained.
+    } else if (count >= config_.retained_topics ||
+               retained_used_ + bytes > config_.retained_arena_size) {
+        ESP_LOGW(TAG, "Retain 0x%04lx: no room (%u topics, %u arena bytes)",
+                 (unsigned long)topic, (unsigned)config_.retained_topics,
+                 (unsigned)config_.retained_arena_size);
+        err = ESP_ERR_NO_MEM;
+    } else if (!InitRetained()) {
+        ESP_LOGE(TAG, "Retain: arena alloc failed");
+        err = ESP_ERR_NO_MEM;
+    } else {
+        new (&retained_[count]) RetainedValue{retained_arena_ + retained_used_,
+                                              static_cast<uint32_t>(max_size)};
+        retained_ids_[count] = topic;
+        retained_used_ += bytes;
+        // Publishers scan [0, count) without the mutex.
+        retained_count_.store(count + 1, std::memory_order_release);
+    }
+    xSemaphoreGive(mutex_);
+    return err;
+}
+
+int MessageBus::FindRetained(uint32_t topic) const {
+    // Retained topics are few; a linear scan of the packed ids beats hashing.
+    const uint32_t count = retained_count_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (retained_ids_[i] == topic) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void MessageBus::StoreRetained(uint32_t topic, const void* data, size_t size,
+                               uint32_t now) {
+    const int index = FindRetained(topic);
+    if (index < 0) {
+        return;
+    }
+    RetainedValue& value = retained_[index];
+    if (size > value.capacity) {
+        ESP_LOGW(TAG, "Topic 0x%04lx: %u bytes exceed retained size %u",
+                 (unsigned long)topic, (unsigned)size, (unsigned)value.capacity);
+        return;
+    }
+    // The mutex is held for one copy of at most `capacity` bytes.  It only
+    // orders concurrent publishers of retained topics; readers never wait.
+    if (xSemaphoreTake(retained_mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Store: mutex timeout");
+        return;
+    }
+    const uint32_t seq = value.seq.load(std::memory_order_relaxed);
+    value.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (size > 0 && data) {
+        memcpy(value.data, data, size);
+    }
+    value.size.store(static_cast<uint32_t>(data ? size : 0), std::memory_order_relaxed);
+    value.timestamp.store(now, std::memory_order_relaxed);
+    value.valid.store(true, std::memory_order_relaxed);
+    value.seq.store(seq + 2, std::memory_order_release);
+    xSemaphoreGive(retained_mutex_);
+}
+
+bool MessageBus::TryCopyRetained(const RetainedValue& value, AsyncPayload* payload,
+                                 bool& valid) {
+    // Returns false if a write overlapped the copy.
+    const uint32_t seq = value.seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+        return false;
+    }
+    valid = value.valid.load(std::memory_order_relaxed);
+    if (valid) {
+        // A torn size is caught by the re-check, but must not overrun first.
+        const uint32_t size = std::min(value.size.load(std::memory_order_relaxed),
+                                       value.capacity);
+        memcpy(payload->DataPtr(), value.data, size);
+        payload->data_size = size;
+        payload->timestamp = value.timestamp.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return value.seq.load(std::memory_order_relaxed) == seq;
+}
+
+MessageBus::AsyncPayload* MessageBus::SnapshotRetained(size_t index, uint32_t topic) {
+    const RetainedValue& value = retained_[index];
+    // Sized for the largest value so the copy fits whatever is retained now.
+    AsyncPayload* payload = AllocPayload(topic, nullptr, value.capacity, 0);
+    if (!payload) {
+        return nullptr;
+    }
+    bool valid  = false;
+    bool copied = false;
+    for (int attempt = 0; attempt < kRetainedReadRetries && !copied; ++attempt) {
+        copied = TryCopyRetained(value, payload, valid);
+    }
+    if (!copied) {
+        // Slow path after repeated overlaps: wait for (and priority-boost) the
+        // publisher, as DataStore::ReadFlat() does.
+        if (xSemaphoreTake(retained_mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGE(TAG, "Replay: mutex timeout");
+            valid = false;
+        } else {
+            TryCopyRetained(value, payload, valid);
+            xSemaphoreGive(retained_mutex_);
+        }
+    }
+    if (!valid) {
+        ReleasePayload(payload);
+        return nullptr;
+    }
+    return payload;
+}
+
+// ---------------------------------------------------------------------------
+// Replay
+// ---------------------------------------------------------------------------
+
+bool MessageBus::Matches(const SubscriberRecord* record, uint32_t topic) {
+    switch (record->match) {
+    case TopicMatch::Exact:
+        return topic == record->topic;
+    case TopicMatch::Range:
+        return topic >= record->topic && topic <= record->topic_last;
+    case TopicMatch::Mask:
+        return (topic & record->topic_mask) == record->topic;
+    }
+    return false;
+}
+
+void MessageBus::ReplayRetained(SubscriberRecord* record) {
+    const uint32_t count = retained_count_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t topic = retained_ids_[i];
+        if (!Matches(record, topic)) {
+            continue;
+        }
+        AsyncPayload* payload = SnapshotRetained(i, topic);
+        if (!payload) {
+            continue;
+        }
+        if (record->mode == DeliveryMode::Worker) {
+            QueueAsync(record, payload, nullptr);   // Ordered with later publishes.
+        } else {
+            Deliver(record, payload);
+            ReleasePayload(payload);
+        }
+    }
+}
+
+bool MessageBus::QueueReplay(SubscriberRecord* record) {
+    // Called with mutex_ held.  Returns true if a ReplayCb must be scheduled.
+    bool matched = false;
+    const uint32_t count = retained_count_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count && !matched; ++i) {
+        matched = Matches(record, retained_ids_[i]);
+    }
+    if (!matched) {
+        return false;
+    }
+    record->refs.fetch_add(1, std::memory_order_relaxed);
+    const bool first = replay_head_ == nullptr;
+    // Prepend; ReplayCb restores subscription order.
+    record->replay_next = replay_head_;
+    replay_head_ = record;
+    return first;
+}
+
+void MessageBus::ReplayCb(void* user_data) {
+    auto* bus = static_cast<MessageBus*>(user_data);
+    if (xSemaphoreTake(bus->mutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Replay: mutex timeout");
+        lv_async_call(ReplayCb, bus);   // Records stay queued; try again.
+        return;
+    }
+    SubscriberRecord* list = bus->replay_head_;
+    bus->replay_head_ = nullptr;
+    xSemaphoreGive(bus->mutex_);
+
+    SubscriberRecord* ordered = nullptr;
+    while (list) {
+        SubscriberRecord* next = list->replay_next;
+        list->replay_next = ordered;
+        ordered = list;
+        list = next;
+    }
+    while (ordered) {
+        SubscriberRecord* next = ordered->replay_next;
+        ordered->replay_next = nullptr;
+        bus->ReplayRetained(ordered);
+        ReleaseRecord(ordered);
+        ordered = next;
+    }
+}
+
+} // namespace msgbus
@@ -0,0 +1,271 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * MessageBus instrumentation (CONFIG_MSGBUS_ENABLE_STATS).
+ */
+
+#include "lvgl_msg_bus/message_bus.h"
+
+#include <new>
+
+#include <esp_log.h>
+
+static const char* TAG = "MsgBusStats";
+
+namespace msgbus {
+
+#if LVGL_MSG_BUS_STATS
+
+// ---------------------------------------------------------------------------
+// Collection
+// ---------------------------------------------------------------------------
+
+void MessageBus::DurationStats::Add(uint32_t us) {
+    count.fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(us, std::memory_order_relaxed);
+
+    uint32_t cur = min_us.load(std::memory_order_relaxed);
+    while (us < cur &&
+           !min_us.compare_exchange_weak(cur, us, std::memory_order_relaxed)) {
+    }
+    cur = max_us.load(std::memory_order_relaxed);
+    while (us > cur &&
+           !max_us.compare_exchange_weak(cur, us, std::memory_order_relaxed)) {
+    }
+}
+
+bool MessageBus::InitStats() {
+    if (topic_stats_) {
+        return true;
+    }
+
+    // Keep the table at most half full so probe sequences stay short.
+    size_t size = 2;
+    while (size < 2 * static_cast<size_t>(CONFIG_MSGBUS_STATS_MAX_TOPICS)) {
+        size <<= 1;
+    }
+    topic_stats_ = new (std::nothrow) TopicCounters[size];
+    if (!topic_stats_) {
+        return false;
+    }
+    topic_stats_mask_ = size - 1;
+    return true;
+}
+
+MessageBus::TopicCounters* MessageBus::TopicStatsFor(uint32_t topic) {
+    if (!topic_stats_) {
+        return nullptr;
+    }
+
+    // Lock-free insert-or-find with linear probing.  A row is claimed with a
+    // compare-exchange on its state, so concurrent publishers of a new topic
+    // agree on one row.
+    size_t index = (topic * 2654435761u) & topic_stats_mask_;
+    for (size_t probe = 0; probe <= topic_stats_mask_; ++probe) {
+        TopicCounters& row = topic_stats_[index];
+        uint32_t state = row.state.load(std::memory_order_acquire);
+        if (state == 0) {
+            if (topics_tracked_.load(std::memory_order_relaxed) >=
+                static_cast<uint32_t>(CONFIG_MSGBUS_STATS_MAX_TOPICS)) {
+                break;  // Stop tracking new topics.
+            }
+            if (row.state.compare_exchange_strong(state, 1,
+                                                  std::memory_order_acq_rel)) {
+                topics_tracked_.fetch_add(1, std::memory_order_relaxed);
+                row.topic.store(topic, std::memory_order_relaxed);
+                row.state.store(2, std::memory_order_release);
+                return &row;
+            }
+        }
+        if (state == 1) {
+            // Another publisher is claiming this row.  Waiting could hang a
+            // preempted claimer's core (or a single-core target), so skip
+            // this one count instead; the row is ready for the next publish.
+            return nullptr;
+        }
+        if (row.topic.load(std::memory_order_relaxed) == topic) {
+            return &row;
+        }
+        index = (index + 1) & topic_stats_mask_;
+    }
+
+    topics_untracked_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void MessageBus::CountDropped(uint32_t topic) {
+    if (TopicCounters* stats = TopicStatsFor(topic)) {
+        stats->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Returns the sample count; min / avg are 0 when nothing was recorded.
+template <typename D>
+uint32_t Summarize(const D& d, uint32_t& min, uint32_t& avg, uint32_t& max) {
+    const uint32_t count = d.count.load(std::memory_order_relaxed);
+    min = count ? d.min_us.load(std::memory_order_relaxed) : 0;
+    max = d.max_us.load(std::memory_order_relaxed);
+    avg = count ? static_cast<uint32_t>(
+                      d.total_us.load(std::memory_order_relaxed) / count)
+                : 0;
+    return count;
+}
+
+} // namespace
+
+bool MessageBus::ReadTopicRow(size_t index, TopicStats& out) const {
+    const TopicCounters& row = topic_stats_[index];
+    if (row.state.load(std::memory_order_acquire) != 2) {
+        return false;
+    }
+    out = TopicStats{
+        row.topic.load(std::memory_order_relaxed),
+        row.publishes.load(std::memory_order_relaxed),
+        row.bytes.load(std::memory_order_relaxed),
+        row.delivered.load(std::memory_order_relaxed),
+        row.throttled.load(std::memory_order_relaxed),
+        row.dropped.load(std::memory_order_relaxed),
+        row.peak_fanout.load(std::memory_order_relaxed),
+    };
+    return true;
+}
+
+void MessageBus::ReadSubscriberStats(const SubscriberRecord* rec,
+                                     SubscriberStats& out) {
+    out.id    = rec->id;
+    out.topic = rec->topic;
+    out.mode  = rec->mode;
+    out.dropped = rec->dropped.load(std::memory_order_relaxed);
+    out.calls = Summarize(rec->exec, out.exec_min_us, out.exec_avg_us, out.exec_max_us);
+    Summarize(rec->latency, out.latency_min_us, out.latency_avg_us, out.latency_max_us);
+}
+
+size_t MessageBus::GetTopicStats(TopicStats* out, size_t max_entries) const {
+    if (!topic_stats_ || !out) {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i <= topic_stats_mask_ && n < max_entries; ++i) {
+        if (ReadTopicRow(i, out[n])) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+size_t MessageBus::GetSubscriberStats(SubscriberStats* out, size_t max_entries) {
+    if (!initialized_ || !out) {
+        return 0;
+    }
+
+    SubscriberTable* table = AcquireTable();
+    if (!table) {
+        return 0;
+    }
+
+    size_t n = 0;
+    TableSlot* slots = table->Slots();
+    for (size_t i = 0; i < table->count && n < max_entries; ++i) {
+        ReadSubscriberStats(slots[i].record, out[n++]);
+    }
+
+    ReleaseTable(table);
+    return n;
+}
+
+#else // !LVGL_MSG_BUS_STATS
+
+void MessageBus::CountDropped(uint32_t /*topic*/) {}
+
+size_t MessageBus::GetTopicStats(TopicStats* /*out*/, size_t /*max_entries*/) const {
+    return 0;
+}
+
+size_t MessageBus::GetSubscriberStats(SubscriberStats* /*out*/,
+                                      size_t /*max_entries*/) {
+    return 0;
+}
+
+#endif // LVGL_MSG_BUS_STATS
+
+BusStats MessageBus::GetBusStats() const {
+    BusStats s{};
+    s.alloc_failures      = alloc_failures_.load(std::memory_order_relaxed);
+    s.pool_heap_fallbacks = payload_pool_.HeapFallbacks();
+    s.pool_failures       = payload_pool_.Failures();
+    s.loan_failures       = loan_pool_.Failures();
+    s.lvgl_shed           = lvgl_shed_.load(std::memory_order_relaxed);
+    s.async_inflight      = inflight_.load(std::memory_order_relaxed);
+    s.dropped_newest      = dropped_newest_.load(std::memory_order_relaxed);
+    s.dropped_oldest      = dropped_oldest_.load(std::memory_order_relaxed);
+    s.block_timeouts      = block_timeouts_.load(std::memory_order_relaxed);
+    s.conflated           = conflated_.load(std::memory_order_relaxed);
+#if LVGL_MSG_BUS_STATS
+    s.topics_untracked    = topics_untracked_.load(std::memory_order_relaxed);
+#endif
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// DumpStats
+// ---------------------------------------------------------------------------
+
+void MessageBus::DumpStats() {
+    const BusStats bus = GetBusStats();
+    ESP_LOGI(TAG, "alloc_failed=%lu pool_heap_fallback=%lu pool_failed=%lu "
+                  "loan_failed=%lu shed=%lu untracked=%lu",
+             (unsigned long)bus.alloc_failures, (unsigned long)bus.pool_heap_fallbacks,
+             (unsigned long)bus.pool_failures, (unsigned long)bus.loan_failures,
+             (unsigned long)bus.lvgl_shed, (unsigned long)bus.topics_untracked);
+    ESP_LOGI(TAG, "inflight=%lu drop_newest=%lu drop_oldest=%lu "
+                  "block_timeout=%lu conflated=%lu",
+             (unsigned long)bus.async_inflight, (unsigned long)bus.dropped_newest,
+             (unsigned long)bus.dropped_oldest, (unsigned long)bus.block_timeouts,
+             (unsigned long)bus.conflated);
+
+#if LVGL_MSG_BUS_STATS
+    ESP_LOGI(TAG, "%-10s %10s %12s %10s %10s %8s %6s", "topic", "publish",
+             "bytes", "delivered", "throttled", "dropped", "fanout");
+    for (size_t i = 0; topic_stats_ && i <= topic_stats_mask_; ++i) {
+        TopicStats t;
+        if (!ReadTopicRow(i, t)) {
+            continue;
+        }
+        ESP_LOGI(TAG, "0x%08lx %10lu %12llu %10lu %10lu %8lu %6lu",
+                 (unsigned long)t.topic, (unsigned long)t.publishes,
+                 (unsigned long long)t.bytes, (unsigned long)t.delivered,
+                 (unsigned long)t.throttled, (unsigned long)t.dropped,
+                 (unsigned long)t.peak_fanout);
+    }
+
+    SubscriberTable* table = initialized_ ? AcquireTable() : nullptr;
+    ESP_LOGI(TAG, "%-6s %-10s %4s %8s %22s %22s", "sub", "topic", "mode",
+             "calls", "exec us min/avg/max", "latency us min/avg/max");
+    for (size_t i = 0; table && i < table->count; ++i) {
+        SubscriberStats st;
+        ReadSubscriberStats(table->Slots()[i].record, st);
+        ESP_LOGI(TAG, "%-6lu 0x%08lx %4d %8lu %6lu/%6lu/%8lu %6lu/%6lu/%8lu",
+                 (unsigned long)st.id, (unsigned long)st.topic,
+                 static_cast<int>(st.mode), (unsigned long)st.calls,
+                 (unsigned long)st.exec_min_us, (unsigned long)st.exec_avg_us,
+                 (unsigned long)st.exec_max_us, (unsigned long)st.latency_min_us,
+                 (unsigned long)st.latency_avg_us, (unsigned long)st.latency_max_us);
+    }
+    if (table) {
+        ReleaseTable(table);
+    }
+#else
+    ESP_LOGI(TAG, "Per-topic / per-subscriber stats disabled "
+                  "(enable CONFIG_MSGBUS_ENABLE_STATS)");
+#endif
+}
+
+} // namespace msgbus
@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * MessageBus event trace (CONFIG_MSGBUS_ENABLE_TRACE): a RAM ring of binary
+ * records and its export for tools/msgbus_trace.py.
+ */
+
+#include "lvgl_msg_bus/message_bus.h"
+
+#include <new>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char* TAG = "MsgBusTrace";
+
+namespace msgbus {
+
+#if LVGL_MSG_BUS_TRACE
+
+namespace {
+
+// A dump is a header followed by TraceRecords, oldest first, up to the end
+// of the stream.  The Hex format carries the same bytes between the marker
+// lines, kHexBytes per line.
+constexpr uint32_t kDumpMagic    = 0x5254424D;   // "MBTR"
+constexpr uint16_t kDumpVersion  = 1;
+constexpr char     kHexPrefix[]  = "MBTRACE:";
+constexpr size_t   kHexBytes     = 32;
+
+struct DumpHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t capacity;   ///< Ring size in records.
+    uint32_t total;      ///< Records written since Initialize(), including overwritten ones.
+};
+
+/// Writes the dump stream in either format.
+class DumpWriter {
+public:
+    DumpWriter(FILE* out, TraceFormat format) : out_(out), format_(format) {
+        if (format_ == TraceFormat::Hex) {
+            fprintf(out_, "\n%sBEGIN\n", kHexPrefix);
+        }
+    }
+
+    void Write(const void* data, size_t size) {
+        if (format_ == TraceFormat::Binary) {
+            fwrite(data, 1, size, out_);
+            return;
+        }
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            line_[used_++] = bytes[i];
+            if (used_ == kHexBytes) {
+                FlushLine();
+            }
+        }
+    }
+
+    /// @return false if any write to the stream failed.
+    bool Finish() {
+        if (format_ == TraceFormat::Hex) {
+            FlushLine();
+            fprintf(out_, "%sEND\n", kHexPrefix);
+        }
+        fflush(out_);
+        return !ferror(out_);
+    }
+
+private:
+    void FlushLine() {
+        if (used_ == 0) {
+            return;
+        }
+        static const char kDigits[] = "0123456789abcdef";
+        char text[2 * kHexBytes + 1];
+        for (size_t i = 0; i < used_; ++i) {
+            text[2 * i]     = kDigits[line_[i] >> 4];
+            text[2 * i + 1] = kDigits[line_[i] & 0x0F];
+        }
+        text[2 * used_] = '\0';
+        fprintf(out_, "%s%s\n", kHexPrefix, text);
+        used_ = 0;
+    }
+
+    FILE*       out_;
+    TraceFormat format_;
+    uint8_t     line_[kHexBytes];
+    size_t      used_ = 0;
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+
+bool MessageBus::InitTrace() {
+    if (trace_) {
+        return true;
+    }
+
+    uint32_t size = 2;
+    while (size < static_cast<uint32_t>(CONFIG_MSGBUS_TRACE_RECORDS)) {
+        size <<= 1;
+    }
+    trace_ = new (std::nothrow) TraceSlot[size];
+    if (!trace_) {
+        return false;
+    }
+    trace_mask_ = size - 1;
+    trace_enabled_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void MessageBus::WriteTrace(TraceEvent event, uint32_t topic, SubscriptionId subscriber,
+                            size_t size) {
+    // Each slot is a small seqlock: a reader that sees the stamp change while
+    // it copies the record discards the copy.  Writers never wait.
+    const uint32_t seq = trace_head_.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot& slot = trace_[seq & trace_mask_];
+    slot.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = TraceRecord{
+        static_cast<uint32_t>(esp_timer_get_time()),
+        topic,
+        subscriber,
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle())),
+        static_cast<uint16_t>(size < 0xFFFF ? size : 0xFFFF),
+        event,
+        static_cast<uint8_t>(xPortGetCoreID()),
+    };
+    slot.stamp.store(seq + 1, std::memory_order_release);
+}
+
+bool MessageBus::ReadTraceSlot(uint32_t seq, TraceRecord& out) const {
+    // A stamp of 0 means "being written" (or never written), so the one
+    // sequence number whose stamp would wrap to 0 is never readable.
+    const uint32_t stamp = seq + 1;
+    const TraceSlot& slot = trace_[seq & trace_mask_];
+    if (stamp == 0 || slot.stamp.load(std::memory_order_acquire) != stamp) {
+        return false;   // Not written yet, being rewritten or overwritten.
+    }
+    out = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.stamp.load(std::memory_order_relaxed) == stamp;
+}
+
+void MessageBus::SetTraceEnabled(bool enabled) {
+    trace_enabled_.store(enabled && trace_, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Export
+// ---------------------------------------------------------------------------
+
+size_t MessageBus::ReadTrace(uint32_t& cursor, TraceRecord* out, size_t max_records) const {
+    if (!trace_ || !out) {
+        return 0;
+    }
+
+    const uint32_t capacity = trace_mask_ + 1;
+    const uint32_t head = trace_head_.load(std::memory_order_acquire);
+    if (head - cursor > capacity) {
+        cursor = head - capacity;   // The older records are gone.
+    }
+    size_t n = 0;
+    while (cursor != head && n < max_records) {
+        if (ReadTraceSlot(cursor, out[n])) {
+            ++n;
+        } else if (trace_head_.load(std::memory_order_acquire) - cursor <= capacity) {
+            break;   // Still being written; pick it up on the next call.
+        }
+        ++cursor;
+    }
+    return n;
+}
+
+esp_err_t MessageBus::DumpTrace(FILE* out, TraceFormat format) {
+    if (!trace_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const bool was_enabled = trace_enabled_.exchange(false, std::memory_order_acq_rel);
+    const uint32_t capacity = trace_mask_ + 1;
+    const uint32_t head = trace_head_.load(std::memory_order_acquire);
+
+    DumpWriter writer(out, format);
+    const DumpHeader header = {kDumpMagic, kDumpVersion,
+                               static_cast<uint16_t>(sizeof(TraceRecord)), capacity, head};
+    writer.Write(&header, sizeof(header));
+    // Slots never written (or torn by a writer still running) fail the stamp
+    // check, so a ring that has not wrapped yet needs no special case.
+    TraceRecord record;
+    for (uint32_t seq = head - capacity; seq != head; ++seq) {
+        if (ReadTraceSlot(seq, record)) {
+            writer.Write(&record, sizeof(record));
+        }
+    }
+    const bool ok = writer.Finish();
+
+    trace_enabled_.store(was_enabled, std::memory_order_relaxed);
+    if (!ok) {
+        ESP_LOGE(TAG, "Trace dump write failed");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+#else // !LVGL_MSG_BUS_TRACE
+
+void MessageBus::SetTraceEnabled(bool /*enabled*/) {}
+
+size_t MessageBus::ReadTrace(uint32_t& /*cursor*/, TraceRecord* /*out*/,
+                             size_t /*max_records*/) const {
+    return 0;
+}
+
+esp_err_t MessageBus::DumpTrace(FILE* /*out*/, TraceFormat /*format*/) {
+    ESP_LOGW(TAG, "Tracing disabled (enable CONFIG_MSGBUS_ENABLE_TRACE)");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // LVGL_MSG_BUS_TRACE
+
+} // namespace msgbus
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ *
+ * MessageBus worker pool: DeliveryMode::Worker subscribers run off the
+ * publisher and off the LVGL task.
+ */
+
+#include "lvgl_msg_bus/message_bus.h"
+
+#include <cstdio>
+#include <new>
+
+#include <esp_log.h>
+
+static const char* TAG = "MsgBusWorker";
+
+namespace msgbus {
+
+// ---------------------------------------------------------------------------
+// Pool
+// ---------------------------------------------------------------------------
+
+esp_err_t MessageBus::StartWorkers() {
+    workers_ = new (std::nothrow) Worker[config_.worker_count];
+    if (!workers_) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < config_.worker_count; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "msgbus_wk%u", (unsigned)i);
+        workers_[i].bus = this;
+        if (xTaskCreatePinnedToCore(WorkerTask, name, config_.worker_task_stack,
+                                    &workers_[i], config_.worker_task_priority,
+                                    &workers_[i].task,
+                                    config_.worker_task_core) != pdPASS) {
+            workers_[i].task = nullptr;   // Initialize() stops the started ones.
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGI(TAG, "Started %u workers (prio %u, core %d)",
+             (unsigned)config_.worker_count, (unsigned)config_.worker_task_priority,
+             (int)config_.worker_task_core);
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Hand-off
+// ---------------------------------------------------------------------------
+
+void MessageBus::WakeWorker(SubscriberRecord* record) {
+    // The caller holds a record reference for the wake-up, and wake_armed
+    // keeps the record on at most one ready list, so the intrusive link is
+    // free.  Pushing never fails: the messages themselves wait in the
+    // record's backlog.
+    Worker& worker = workers_[record->worker];
+    SubscriberRecord* head = worker.ready.load(std::memory_order_relaxed);
+    do {
+        record->worker_next = head;
+    } while (!worker.ready.compare_exchange_weak(head, record, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    if (!head) {
+        xTaskNotifyGive(worker.task);   // Only an idle list needs a wake-up.
+    }
+}
+
+void MessageBus::WorkerTask(void* arg) {
+    auto* worker = static_cast<Worker*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Take every woken record at once and restore wake-up order.
+        SubscriberRecord* list = worker->ready.exchange(nullptr, std::memory_order_acquire);
+        SubscriberRecord* ordered = nullptr;
+        while (list) {
+            SubscriberRecord* next = list->worker_next;
+            list->worker_next = ordered;
+            ordered = list;
+            list = next;
+        }
+        while (ordered) {
+            // DrainBacklog() may re-queue the record, which rewrites the link.
+            SubscriberRecord* next = ordered->worker_next;
+            worker->bus->DrainBacklog(ordered);
+            ReleaseRecord(ordered);
+            ordered = next;
+        }
+    }
+}
+
+} // namespace msgbus
@@ -0,0 +1,190 @@
+/*
+ * SPDX-FileCopyrightText: 2025 txp666
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lvgl_msg_bus/payload_pool.h"
+
+#include <cstdlib>
+
+#include <esp_log.h>
+
+static const char* TAG = "MsgBusPool";
+
+namespace msgbus {
+
+namespace {
+
+constexpr size_t kBlockAlign = alignof(max_align_t);
+
+size_t AlignUp(size_t n) {
+    return (n + kBlockAlign - 1) & ~(kBlockAlign - 1);
+}
+
+} // namespace
+
+PayloadPool::~PayloadPool() {
+    Release();
+}
+
+void PayloadPool::Release() {
+    for (size_t i = 0; i < class_count_; ++i) {
+        heap_caps_free(classes_[i].arena);
+        classes_[i] = SizeClass{};
+    }
+    class_count_ = 0;
+    if (freed_) {
+        vSemaphoreDelete(freed_);
+        freed_ = nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Init
+// ---------------------------------------------------------------------------
+
+esp_err_t PayloadPool::Init(const PayloadPoolConfig& config,
+                            size_t header_size) {
+    // Allow a retry after a failed Init().
+    Release();
+    config_ = config;
+
+    for (size_t i = 0; i < PayloadPoolConfig::kMaxClasses; ++i) {
+        if (config_.block_sizes[i] == 0 || config_.block_counts[i] == 0) {
+            continue;
+        }
+
+        SizeClass& cls = classes_[class_count_];
+        cls.block_size = AlignUp(header_size + config_.block_sizes[i]);
+        cls.count      = config_.block_counts[i];
+        cls.arena      = static_cast<uint8_t*>(
+            heap_caps_malloc(cls.block_size * cls.count, config_.caps));
+        if (!cls.arena) {
+            ESP_LOGE(TAG, "Arena alloc failed (%u x %u bytes, caps=0x%lx)",
+                     (unsigned)cls.count, (unsigned)cls.block_size,
+                     (unsigned long)config_.caps);
+            return ESP_ERR_NO_MEM;
+        }
+
+        // Thread every block onto the free list.
+        cls.free_list = nullptr;
+        for (size_t b = cls.count; b-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(cls.arena + b * cls.block_size);
+            block->next = cls.free_list;
+            cls.free_list = block;
+        }
+        ++class_count_;
+
+        ESP_LOGD(TAG, "Class %u: %u x %u bytes", (unsigned)i,
+                 (unsigned)cls.count, (unsigned)cls.block_size);
+    }
+
+    if (config_.policy == PoolExhaustPolicy::Block) {
+        freed_ = xSemaphoreCreateBinary();
+        if (!freed_) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Alloc / Free
+// ---------------------------------------------------------------------------
+
+void* PayloadPool::TryAlloc(size_t size) {
+    void* block = nullptr;
+    portENTER_CRITICAL(&lock_);
+    // Classes are ascending: take the smallest fitting class with a free block.
+    for (size_t i = 0; i < class_count_; ++i) {
+        SizeClass& cls = classes_[i];
+        if (cls.block_size >= size && cls.free_list) {
+            block = cls.free_list;
+            cls.free_list = cls.free_list->next;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock_);
+    return block;
+}
+
+void* PayloadPool::Alloc(size_t size) {
+    void* block = TryAlloc(size);
+    if (block) {
+        return block;
+    }
+
+    switch (config_.policy) {
+    case PoolExhaustPolicy::Drop:
+        break;
+
+    case PoolExhaustPolicy::Block: {
+        if (class_count_ == 0 || size > classes_[class_count_ - 1].block_size) {
+            break;  // No class can ever satisfy this request.
+        }
+        const TickType_t start   = xTaskGetTickCount();
+        const TickType_t timeout = pdMS_TO_TICKS(config_.block_timeout_ms);
+        waiters_.fetch_add(1, std::memory_order_acq_rel);
+        // Re-check after registering as a waiter so a Free() racing with the
+        // failed TryAlloc() above is not missed.
+        while (!(block = TryAlloc(size))) {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout ||
+                xSemaphoreTake(freed_, timeout - elapsed) != pdTRUE) {
+                break;
+            }
+        }
+        waiters_.fetch_sub(1, std::memory_order_acq_rel);
+        break;
+    }
+
+    case PoolExhaustPolicy::HeapFallback:
+        block = malloc(size);
+        if (block) {
+            heap_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+        }
+        break;
+    }
+
+    if (!block) {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return block;
+}
+
+int PayloadPool::ClassOf(const void* block) const {
+    const auto* p = static_cast<const uint8_t*>(block);
+    for (size_t i = 0; i < class_count_; ++i) {
+        const SizeClass& cls = classes_[i];
+        if (p >= cls.arena && p < cls.arena + cls.block_size * cls.count) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void PayloadPool::Free(void* block) {
+    if (!block) {
+        return;
+    }
+
+    const int index = ClassOf(block);
+    if (index < 0) {
+        // Heap fallback block.
+        free(block);
+        return;
+    }
+
+    SizeClass& cls = classes_[index];
+    auto* node = static_cast<FreeBlock*>(block);
+    portENTER_CRITICAL(&lock_);
+    node->next    = cls.free_list;
+    cls.free_list = node;
+    portEXIT_CRITICAL(&lock_);
+
+    if (freed_ && waiters_.load(std::memory_order_acquire) > 0) {
+        xSemaphoreGive(freed_);
+    }
+}
+
+} // namespace msgbus
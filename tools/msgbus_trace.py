@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2025 txp666
+# SPDX-License-Identifier: MIT
+"""Convert a MessageBus::DumpTrace() capture to Chrome / Perfetto trace JSON.
+
+The input is either a binary dump (TraceFormat::Binary, e.g. copied off an SD
+card) or a console log holding a TraceFormat::Hex dump (the "MBTRACE:" lines
+may be mixed with other output; the last complete dump is used).
+
+    tools/msgbus_trace.py monitor.log -o trace.json
+
+Open the result in https://ui.perfetto.dev or chrome://tracing.  Every task
+that touched the bus becomes a track: publishes, throttle skips, enqueues and
+drops are markers, callbacks are slices, and an arrow links each queued
+delivery to the callback that consumed it.  A per-subscriber summary is
+printed to stderr.
+"""
+
+import argparse
+import collections
+import json
+import re
+import struct
+import sys
+
+DUMP_MAGIC = 0x5254424D  # "MBTR"
+DUMP_VERSION = 1
+HEADER = struct.Struct("<IHHII")  # magic, version, record_size, capacity, total
+RECORD = struct.Struct("<IIIIHBB")  # time_us, topic, subscriber, task, size, event, core
+
+EVENTS = ["publish", "throttle", "enqueue", "replace", "drop", "evict",
+          "dispatch_begin", "dispatch_end"]
+(PUBLISH, THROTTLE, ENQUEUE, REPLACE, DROP, EVICT,
+ DISPATCH_BEGIN, DISPATCH_END) = range(len(EVENTS))
+
+HEX_LINE = re.compile(r"MBTRACE:(BEGIN|END|[0-9a-fA-F]+)")
+
+
+def load_dump(path):
+    """Return the raw dump bytes from a binary file or a console log."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) >= 4 and struct.unpack_from("<I", data)[0] == DUMP_MAGIC:
+        return data
+
+    dumps, current = [], None
+    for line in data.decode("ascii", errors="replace").splitlines():
+        m = HEX_LINE.search(line)
+        if not m:
+            continue
+        token = m.group(1)
+        if token == "BEGIN":
+            current = bytearray()
+        elif token == "END":
+            if current is not None:
+                dumps.append(bytes(current))
+            current = None
+        elif current is not None:
+            current += bytes.fromhex(token)
+    if not dumps:
+        sys.exit(f"{path}: no binary trace and no complete MBTRACE dump")
+    return dumps[-1]
+
+
+def parse(data):
+    magic, version, record_size, capacity, total = HEADER.unpack_from(data)
+    if magic != DUMP_MAGIC or version != DUMP_VERSION or record_size != RECORD.size:
+        sys.exit(f"unsupported trace dump (magic 0x{magic:08x}, version {version}, "
+                 f"record size {record_size})")
+    records = []
+    high, last = 0, None
+    body = data[HEADER.size:]
+    for fields in RECORD.iter_unpack(body[:len(body) - len(body) % RECORD.size]):
+        time_us, topic, sub, task, size, event, core = fields
+        # Records are in claim order, so the 32-bit clock only wraps forwards;
+        # small backwards steps are cross-core skew.
+        if last is not None and time_us < last and last - time_us > 1 << 31:
+            high += 1 << 32
+        last = time_us
+        records.append((high + time_us, topic, sub, task, size, event, core))
+    records.sort(key=lambda r: r[0])
+    return capacity, total, records
+
+
+def convert(records):
+    events = []
+    tids = {}
+    pending = collections.defaultdict(collections.deque)  # subscriber -> [(ts, flow id)]
+    stacks = collections.defaultdict(list)                # tid -> open callbacks
+    calls = collections.defaultdict(list)                 # subscriber -> [(dur, queued)]
+    next_flow = 1
+    start = records[0][0] if records else 0
+
+    def tid_of(task, core):
+        if task not in tids:
+            tids[task] = len(tids) + 1
+            events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tids[task],
+                           "args": {"name": f"task 0x{task:08x} (core {core})"}})
+        return tids[task]
+
+    events.append({"ph": "M", "name": "process_name", "pid": 1,
+                   "args": {"name": "msgbus"}})
+    for ts, topic, sub, task, size, event, core in records:
+        tid = tid_of(task, core)
+        ts -= start
+        args = {"topic": f"0x{topic:04x}", "size": size, "core": core}
+        if sub:
+            args["subscriber"] = sub
+
+        if event == DISPATCH_BEGIN:
+            flow = pending[sub].popleft() if pending[sub] else None
+            stacks[tid].append((ts, topic, sub, size, core, flow))
+        elif event == DISPATCH_END:
+            stack = stacks[tid]
+            while stack and stack[-1][2] != sub:
+                stack.pop()  # Begin lost to the ring; drop the unmatched entry.
+            if not stack:
+                continue
+            begin, topic, sub, size, core, flow = stack.pop()
+            slice_ = {"ph": "X", "name": f"sub {sub} 0x{topic:04x}", "cat": "callback",
+                      "pid": 1, "tid": tid, "ts": begin, "dur": ts - begin, "args": args}
+            queued = None
+            if flow:
+                queued = begin - flow[0]
+                args["queued_us"] = queued
+                slice_.update({"bind_id": flow[1], "flow_in": True})
+            calls[sub].append((ts - begin, queued))
+            events.append(slice_)
+        elif event in (ENQUEUE, REPLACE):
+            if event == REPLACE:
+                pending[sub].clear()  # The replaced message is never delivered.
+            pending[sub].append((ts, next_flow))
+            events.append({"ph": "X", "name": EVENTS[event], "cat": "queue", "pid": 1,
+                           "tid": tid, "ts": ts, "dur": 0, "args": args,
+                           "bind_id": next_flow, "flow_out": True})
+            next_flow += 1
+        else:
+            if event == EVICT and pending[sub]:
+                pending[sub].popleft()
+            name = EVENTS[event] if event < len(EVENTS) else f"event {event}"
+            if event == PUBLISH:
+                name = f"publish 0x{topic:04x}"
+            events.append({"ph": "i", "s": "t", "name": name, "cat": "bus", "pid": 1,
+                           "tid": tid, "ts": ts, "args": args})
+    return events, calls
+
+
+def summarize(calls, out):
+    print(f"{'sub':>6} {'calls':>8} {'exec avg/max us':>18} {'queued avg/max us':>20}",
+          file=out)
+    for sub in sorted(calls):
+        durs = [d for d, _ in calls[sub]]
+        queued = [q for _, q in calls[sub] if q is not None]
+        exec_ = f"{sum(durs) // len(durs)}/{max(durs)}"
+        wait = f"{sum(queued) // len(queued)}/{max(queued)}" if queued else "-"
+        print(f"{sub:>6} {len(durs):>8} {exec_:>18} {wait:>20}", file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="binary dump or console log with a hex dump")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    capacity, total, records = parse(load_dump(args.input))
+    events, calls = convert(records)
+    trace = {"traceEvents": events, "displayTimeUnit": "ms",
+             "otherData": {"records": len(records), "written": total,
+                           "capacity": capacity}}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+    print(f"{len(records)} records ({total} written, ring of {capacity})", file=sys.stderr)
+    summarize(calls, sys.stderr)
+
+
+if __name__ == "__main__":
+    main()